@@ -6,3 +6,7 @@ STYX_INC_EXTRA  := include-sparc
 HOST            := sparc-all-bros-
 # CPUFLAGS        := -msoft-float
 
+# For modules which run code in interrupt context, where an FPU
+# access is fatal.
+ISRFLAGS        := -msoft-float
+
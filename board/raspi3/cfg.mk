@@ -8,3 +8,7 @@ CPUFLAGS        += -mabi=lp64
 # CPUFLAGS        += -march=armv8-a
 # CPUFLAGS        += -mgeneral-regs-only
 
+# For modules which run code in interrupt context, where an
+# FP/SIMD access is fatal.
+ISRFLAGS        := -mgeneral-regs-only
+
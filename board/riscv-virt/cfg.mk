@@ -8,3 +8,7 @@ CPUFLAGS        := -march=rv32ima   -mabi=ilp32
 # CPUFLAGS        := -march=rv64ima   -mabi=lp64  -mcmodel=medany
 # CPUFLAGS        := -march=rv64imafd -mabi=lp64d -mcmodel=medany
 
+# GCC has no option to keep RISC-V integer code off the F
+# registers, but it does not use them for it. So modules which
+# run in interrupt context need no ISRFLAGS here.
+
@@ -10,6 +10,13 @@ struct TaskArch {
   /* HW adds one 32-bit word if SP was not 8-byte aligned at stacking */
 };
 
+/* Saved by port_coswitch() */
+struct CoFrame {
+  unsigned r8, r9, r10, r11;
+  unsigned r4, r5, r6, r7;
+  unsigned pc;
+};
+
 void *kcstart(void);
 void kprint_cpu(Lib *lib);
 void kprint_regs(Lib *lib, TaskArch *arch, unsigned ipsr);
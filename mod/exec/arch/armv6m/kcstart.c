@@ -15,6 +15,11 @@
 #define dbg(...)
 #endif
 
+/* port_get_timestamp() has no counter to read on ARMv6-M. */
+#if CFG_TASKSTATS || CFG_LATENCY
+# error "CFG_TASKSTATS and CFG_LATENCY need port_get_timestamp()"
+#endif
+
 Lib *AbsExecBase;
 /*
  * Rules for ThisTask
@@ -109,7 +114,7 @@ void port_disable_intnum(int intnum) {
   if (extint < 0) {
     return;
   }
-  nvic_clear_enable(intnum);
+  nvic_clear_enable(extint);
 }
 
 static int get_numinterrupts(void) {
@@ -180,6 +185,20 @@ void iReschedule(Lib *lib) {
   dsb_and_isb();
 }
 
+int port_get_ncpu(Lib *lib) {
+  return 1;
+}
+
+/*
+ * PendSV has the lowest priority so it tail-chains after the last
+ * active interrupt handler. theswitch() drains the software
+ * interrupts before it selects the next task.
+ */
+void port_raise_softint(void) {
+  scb->icsr = SCB_ICSR_PENDSVSET;
+  dsb_and_isb();
+}
+
 /*
  * Going for pendsv when voluntary leaving the cpu may waste
  * some interrupt disable time and stack because there is no
@@ -194,6 +213,30 @@ void iSwitch(Lib *lib) {
   svc0();
 }
 
+/*
+ * theswitch() runs the head of taskready, which is the caller. If
+ * the next task has the same priority, the caller goes behind it
+ * and its peers. Else there is nothing to switch to.
+ */
+void iYield(Lib *lib) {
+  Task *task;
+  Node *next;
+  int peer;
+
+  task = priv.ThisTask;
+  lObtainIntLock(lib, &lib->tasklock);
+  next = task->node.succ;
+  peer = next->succ && next->pri == task->node.pri;
+  if (peer) {
+    iRemove(lib, &task->node);
+    iEnqueue(lib, &lib->taskready, &task->node);
+  }
+  lReleaseIntLock(lib, &lib->tasklock);
+  if (peer) {
+    iSwitch(lib);
+  }
+}
+
 static void checkstack(Lib *lib, const Task *const task) {
   char *spreg;
   char *spwashere;
@@ -228,21 +271,24 @@ static TaskArch *theswitch(Lib *lib, TaskArch *arch) {
   }
   lReleaseIntLock(lib, &lib->tasklock);
   if (removed) {
-    lSignal(lib, lib->cleantask, SIGF_CLEANUP);
+    lQueueWork(lib, &lib->cleanwork, WORK_ANYCPU);
   }
 
+  /*
+   * PendSV is cleared before the software interrupts run, so one
+   * caused after that pends it again and is not lost.
+   */
   task = NULL;
-  lObtainIntLock(lib, &lib->tasklock);
   do {
+    scb->icsr = SCB_ICSR_PENDSVCLR;
+    runsoftints(lib);
+    lObtainIntLock(lib, &lib->tasklock);
     task = (Task *) iGetHead(lib, &lib->taskready);
+    lReleaseIntLock(lib, &lib->tasklock);
     if (task == NULL) {
-      lReleaseIntLock(lib, &lib->tasklock);
       wfe();
-      lObtainIntLock(lib, &lib->tasklock);
     }
-    scb->icsr = SCB_ICSR_PENDSVCLR;
   } while (task == NULL);
-  lReleaseIntLock(lib, &lib->tasklock);
 
   priv.ThisTask = task;
   dbg("to %s (sp %p)\n", task->node.name, task->arch);
@@ -280,6 +326,26 @@ void port_prepstack(Lib *lib, Task *task) {
   task->canaries.num = 3;
 }
 
+static void costart(void) {
+  coentry(AbsExecBase);
+}
+
+/* ARMv6-M has no FPU. */
+int port_usedfpu(const Task *task) {
+  return 0;
+}
+
+void *port_coprep(void *top) {
+  struct CoFrame *f;
+
+  f = (struct CoFrame *) ((unsigned) top & ~7U);
+  f--;
+  *f = (struct CoFrame) { 0 };
+  /* The Thumb bit is set in the function address. */
+  f->pc = (unsigned) costart;
+  return f;
+}
+
 Task *port_ThisTask(Lib *lib) {
   KASSERT(priv.ThisTask);
   return priv.ThisTask;
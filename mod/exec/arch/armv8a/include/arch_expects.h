@@ -6,3 +6,6 @@ void any_interrupt(
   unsigned int cpunum
 );
 
+/* Return 1 if a trapped FP/SIMD access was handled. */
+int fputrap(Lib *lib);
+
@@ -22,6 +22,9 @@
  * x18: PR reserved for the use of platform ABIs
  * x29: FP
  * x30: LR
+ *
+ * tpidr_el1: PortCPU
+ * tpidr_el0: running Task, set by port_switch_tasks()
  */
 
 /* Stacked on exception (interrupt) entry. */
@@ -54,11 +57,50 @@ struct TaskArch {
   unsigned long x30; /* lr */
 };
 
+/* Saved by port_coswitch(), d only if fpu is non-zero */
+struct CoFrame {
+  TaskArch arch;
+  unsigned long d[8];   /* d8..d15 */
+  unsigned long fpu;    /* fpu argument of port_coswitch() */
+  unsigned long pad;
+};
+
+/* FP/SIMD registers of a task, above its initial TaskArch. */
+struct FPUArea {
+  unsigned long q[32][2];
+  unsigned long fpcr;
+  unsigned long fpsr;
+  ExecCPU *cpu;         /* registers of this CPU hold the state */
+  unsigned long pad;
+};
+
 void kcstart(unsigned long id);
 void kprint_cpu(Lib *lib);
 void theexc(Lib *lib, struct fullframe *ef);
 
 unsigned long get_midr(void);
+unsigned long get_isar0(void);
+/* Stop trapping FP/SIMD on this CPU, by CPACR_EL1.FPEN */
+void armv8a_fpu_enable(void);
+void armv8a_fpu_restore(const struct FPUArea *fpu);
+
+/* ID_AA64ISAR0_EL1.Atomic is 2 or more with LSE */
+#define ISAR0_ATOMIC(isar0) (((isar0) >> 20) & 0xf)
+
+/* Atomic operations using LSE, installed by setatomic() */
+unsigned int iAtomicCompareSwapLSE(Lib *lib, volatile unsigned int *p,
+ unsigned int old, unsigned int new);
+void *iAtomicCompareSwapPtrLSE(Lib *lib, void *volatile *p, void *old,
+ void *new);
+unsigned int iAtomicSwapLSE(Lib *lib, volatile unsigned int *p,
+ unsigned int val);
+void *iAtomicSwapPtrLSE(Lib *lib, void *volatile *p, void *val);
+unsigned int iAtomicAddLSE(Lib *lib, volatile unsigned int *p,
+ unsigned int val);
+unsigned int iAtomicAndLSE(Lib *lib, volatile unsigned int *p,
+ unsigned int val);
+unsigned int iAtomicOrLSE(Lib *lib, volatile unsigned int *p,
+ unsigned int val);
 
 #define LINKER_SYMBOL(sym) extern char sym [];
 
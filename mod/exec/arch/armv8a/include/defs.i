@@ -82,6 +82,21 @@ STRUCTDEF taskarch
         LONG    x30
 ENDSTRUCT
 
+STRUCTDEF coframe
+        STRUCT  taskarch arch
+        ARRAY   64 d
+        LONG    fpu
+        LONG    pad
+ENDSTRUCT
+
+STRUCTDEF fpuarea
+        ARRAY   512 q
+        LONG    fpcr
+        LONG    fpsr
+        ADDR    cpu
+        LONG    pad
+ENDSTRUCT
+
 STRUCTDEF Node
         ADDR    succ
         ADDR    pred
@@ -107,6 +122,12 @@ STRUCTDEF PortCPU
         ADDR    removing
         ADDR    heir
         ADDR    idle
+        LONG    rcuepoch
+        ADDR    softint_head
+        ADDR    softint_tail
+        ADDR    softint_tailpred
+        ADDR    fparea
+        LONG    fpused
         STRUCT  intframe tmpstack
         ARRAY   4096 isrstack
 ENDSTRUCT
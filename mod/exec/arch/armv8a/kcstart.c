@@ -6,6 +6,7 @@
 #include <port.h>
 #include <arch_priv.h>
 #include <arch_expects.h>
+#include <exec/offset.h>
 
 #define LOG_MASK_INFO 2
 #if 1
@@ -26,6 +27,10 @@ static struct {
 
 struct PortCPU {
   ExecCPU cpu;
+  /* FP/SIMD registers hold this state, see fputrap(). */
+  struct FPUArea *fparea;
+  /* The running task has FP/SIMD enabled. */
+  unsigned long fpused;
   /* Set as sp in port_switch_tasks() when no task assigned to CPU. */
   struct intframe tmpstack;
   /* FIXME: get rid of linker stack because we have this */
@@ -37,12 +42,37 @@ ExecCPU *port_alloc_cpu(Lib *lib)
   return lAllocMem(lib, sizeof (struct PortCPU), MEMF_CLEAR | MEMF_ANY);
 }
 
+static void setfunc(Lib *lib, int offset, void (*func)(void)) {
+  iSetFunction(lib, &lib->lib, offset, func, NULL);
+}
+
+/* Use the Large System Extension atomics if the CPU has them. */
+static void setatomic(Lib *lib) {
+  if (ISAR0_ATOMIC(get_isar0()) < 2) {
+    return;
+  }
+  setfunc(lib, offset_AtomicCompareSwap,
+   (void (*)(void)) iAtomicCompareSwapLSE);
+  setfunc(lib, offset_AtomicCompareSwapPtr,
+   (void (*)(void)) iAtomicCompareSwapPtrLSE);
+  setfunc(lib, offset_AtomicSwap, (void (*)(void)) iAtomicSwapLSE);
+  setfunc(lib, offset_AtomicSwapPtr, (void (*)(void)) iAtomicSwapPtrLSE);
+  setfunc(lib, offset_AtomicAdd, (void (*)(void)) iAtomicAddLSE);
+  setfunc(lib, offset_AtomicAnd, (void (*)(void)) iAtomicAndLSE);
+  setfunc(lib, offset_AtomicOr, (void (*)(void)) iAtomicOrLSE);
+}
+
 void kcstart(unsigned long id) {
   Lib *const lib = &theexecbase.lib;
   AbsExecBase = lib;
   iRawIOInit(lib);
   initlib(lib);
-  lib->minstack = 8 * 1024;
+  setatomic(lib);
+  /*
+   * Only the outermost interrupt frame lands on a task stack,
+   * see isrstack. The FPUArea is carved from the stack too.
+   */
+  lib->minstack = 4 * 1024;
   lib->trapcode = default_trapcode;
 
   /* we may now call exec functions but not allocate memory */
@@ -64,20 +94,76 @@ static void trampo(void) {
   task_entry(AbsExecBase);
 }
 
+static struct FPUArea *getfpu(const Task *task) {
+  return (struct FPUArea *) ((unsigned long) task->spupper & ~15U) - 1;
+}
+
 void port_prepstack(Lib *lib, Task *task) {
   TaskArch *arch;
+  struct FPUArea *fpu;
 
-  arch = (TaskArch *) ((unsigned long) task->spupper & ~15U);
+  fpu = getfpu(task);
+  *fpu = (struct FPUArea) { 0 };
+  arch = (TaskArch *) fpu;
   arch--;
   arch->x30 = (unsigned long) trampo;
   task->arch = arch;
   task->canaries.num = 5;
 }
 
+static void costart(void) {
+  coentry(AbsExecBase);
+}
+
+void *port_coprep(void *top) {
+  struct CoFrame *f;
+
+  f = (struct CoFrame *) ((unsigned long) top & ~15UL);
+  f--;
+  *f = (struct CoFrame) { 0 };
+  f->arch.x30 = (unsigned long) costart;
+  return f;
+}
+
 int port_interrupt_is_enabled(int level) {
   return (level & SPSR_DAIF_I) == 0;
 }
 
+/*
+ * Called from exc_sync on the first FP/SIMD access of a task
+ * since port_switch_tasks(). The registers are only loaded if
+ * they do not hold the state of the task already, which is the
+ * case when no other task used FP/SIMD on this CPU since. The
+ * task may continue on any CPU, so port_switch_tasks() writes
+ * the registers back when fpused is set.
+ *
+ * Interrupt handlers shall not use FP/SIMD. exec is built with
+ * -mgeneral-regs-only for that reason.
+ */
+int fputrap(Lib *lib) {
+  struct PortCPU *pcpu;
+  struct FPUArea *fpu;
+
+  pcpu = (struct PortCPU *) port_get_cpu();
+  if (pcpu->cpu.isr_nest != 0) {
+    return 0;
+  }
+  fpu = getfpu(port_ThisTask(lib));
+  armv8a_fpu_enable();
+  if (pcpu->fparea != fpu || fpu->cpu != &pcpu->cpu) {
+    armv8a_fpu_restore(fpu);
+    pcpu->fparea = fpu;
+    fpu->cpu = &pcpu->cpu;
+  }
+  pcpu->fpused = 1;
+  return 1;
+}
+
+/* FPUArea.cpu is set at the first FP/SIMD access of the task. */
+int port_usedfpu(const Task *task) {
+  return getfpu(task)->cpu != NULL;
+}
+
 void theexc(Lib *lib, struct fullframe *ff) {
   ExecCPU *cpu;
 
@@ -15,7 +15,7 @@
  * a0-a7:       arguments
  * t0-t6:       temporary
  * s0-s11:      saved
- * tp:          thread pointer (not used)
+ * tp:          running Task, set by port_switch_tasks()
  * gp:          not for exec. saved/restored with task
  * sp:          stack pointer
  * ra:          return address
@@ -50,12 +50,31 @@ struct TaskArch {
   unsigned long ra;
 };
 
+/*
+ * Saved by port_coswitch(). arch.gp holds its fpu argument, and fs
+ * is only saved if that is non-zero.
+ */
+struct CoFrame {
+  TaskArch arch;
+  unsigned long long fs[12];
+};
+
+/* F/D registers of a task, above its initial TaskArch. */
+struct FPUArea {
+  unsigned long long f[32];
+  unsigned long fcsr;
+  ExecCPU *cpu;         /* registers of this CPU hold the state */
+};
+
 extern char entry_for_secondary;
 void kcstart(unsigned long id);
 void kprint_cpu(Lib *lib);
 void theexc(Lib *lib, struct fullframe *ff);
 void riscv_fence_rw(void);
 void riscv_fence_i(void);
+/* Return 1 if sstatus.FS was Off and could be turned on. */
+int riscv_fpu_enable(void);
+void riscv_fpu_restore(const struct FPUArea *fpu);
 
 #if __riscv_xlen == 32
  #define PR_REG "%08x"
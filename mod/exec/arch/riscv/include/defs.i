@@ -61,6 +61,18 @@ STRUCTDEF taskarch
         LONG    ra
 ENDSTRUCT
 
+/* Coroutine context, taskarch_gp is the fpu flag */
+STRUCTDEF coframe
+        STRUCT  taskarch arch
+        ARRAY   96 fs
+ENDSTRUCT
+
+STRUCTDEF fpuarea
+        ARRAY   256 f
+        LONG    fcsr
+        ADDR    cpu
+ENDSTRUCT
+
 STRUCTDEF Node
         ADDR    succ
         ADDR    pred
@@ -88,6 +100,15 @@ STRUCTDEF PortCPU
         ADDR    removing
         ADDR    heir
         ADDR    idle
+        LONG    rcuepoch
+        ADDR    softint_head
+        ADDR    softint_tail
+        ADDR    softint_tailpred
+        ADDR    fparea
+        LONG    fpused
+.if XLEN == 32
+        ARRAY   8 fppad
+.endif
         STRUCT  excframe tmpstack
         ARRAY   4096 isrstack
 ENDSTRUCT
@@ -22,6 +22,24 @@ REGBYTES = XLEN / 8
  .endm
 .endif
 
+.ifdef FLEN
+.if FLEN == 32
+ .macro FSREG a b
+        fsw \a, \b
+ .endm
+ .macro FLREG a b
+        flw \a, \b
+ .endm
+.else
+ .macro FSREG a b
+        fsd \a, \b
+ .endm
+ .macro FLREG a b
+        fld \a, \b
+ .endm
+.endif
+.endif
+
 .macro FUNC_BEGIN name
         .global \name
         .type \name, @function
@@ -10,6 +10,8 @@
 #define RISCV_SSTATUS_SIE   0x0002
 #define RISCV_SSTATUS_FS    (3<<13)
 
+#define RISCV_EXCEPTION_ILLEGAL_INSTRUCTION    2
+
 #define RISCV_INTERRUPT_SOFTWARE_SUPERVISOR    1
 #define RISCV_INTERRUPT_TIMER_SUPERVISOR       5
 #define RISCV_INTERRUPT_EXTERNAL_SUPERVISOR    9
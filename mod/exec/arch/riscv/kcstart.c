@@ -27,6 +27,13 @@ static struct {
 
 struct PortCPU {
   ExecCPU cpu;
+  /* F/D registers hold this state, see fputrap(). */
+  struct FPUArea *fparea;
+  /* The running task has sstatus.FS on. */
+  unsigned long fpused;
+#if __riscv_xlen == 32
+  unsigned long fppad[2];
+#endif
   /* Set as sp in port_switch_tasks() when no task assigned to CPU. */
   struct excframe tmpstack;
   unsigned long long isrstack[4096 / sizeof (unsigned long long)];
@@ -42,7 +49,8 @@ void kcstart(unsigned long id) {
   AbsExecBase = lib;
   iRawIOInit(lib);
   initlib(lib);
-  lib->minstack = 8 * 1024;
+  /* Only the outermost interrupt frame lands on a task stack. */
+  lib->minstack = 2 * 1024;
   lib->trapcode = default_trapcode;
 
   /* we may now call exec functions but not allocate memory */
@@ -66,8 +74,14 @@ static void trampo(void) {
 
 void port_prepstack(Lib *lib, Task *task) {
   TaskArch *arch;
+  char *top;
 
-  arch = (TaskArch *) ((unsigned long) task->spupper & ~7U);
+  top = (char *) ((unsigned long) task->spupper & ~7U);
+#ifdef __riscv_flen
+  top -= sizeof (struct FPUArea);
+  *(struct FPUArea *) top = (struct FPUArea) { 0 };
+#endif
+  arch = (TaskArch *) top;
   arch--;
   task->spupper = arch;
   arch->ra = (unsigned long) trampo;
@@ -75,13 +89,80 @@ void port_prepstack(Lib *lib, Task *task) {
   task->canaries.num = 5;
 }
 
+static void costart(void) {
+  coentry(AbsExecBase);
+}
+
+void *port_coprep(void *top) {
+  struct CoFrame *f;
+
+  f = (struct CoFrame *) ((unsigned long) top & ~15UL);
+  f--;
+  *f = (struct CoFrame) { 0 };
+  f->arch.ra = (unsigned long) costart;
+  return f;
+}
+
 int port_interrupt_is_enabled(int level) {
   return level & RISCV_SSTATUS_SIE;
 }
 
+#ifdef __riscv_flen
+/* The FPUArea is above the initial TaskArch. */
+static struct FPUArea *getfpu(const Task *task) {
+  return (struct FPUArea *) ((TaskArch *) task->spupper + 1);
+}
+
+/*
+ * sstatus.FS is Off when a task is switched to, so its first F/D
+ * instruction is illegal and ends up here. We turn FS on and load
+ * the registers, unless they already hold the state of the task:
+ * no other task used them on this CPU since, and the task did not
+ * use them on another CPU. A task can continue on any CPU, so
+ * port_switch_tasks() writes them back if fpused is set. Tasks
+ * which never use F/D are not affected.
+ *
+ * FS is per CPU: the exception exit keeps it rather than the
+ * value in the excframe, which may be from another CPU.
+ */
+static int fputrap(Lib *lib) {
+  struct PortCPU *pcpu;
+  struct FPUArea *fpu;
+
+  pcpu = (struct PortCPU *) port_get_cpu();
+  if (pcpu->cpu.isr_nest != 0 || !riscv_fpu_enable()) {
+    return 0;
+  }
+  fpu = getfpu(port_ThisTask(lib));
+  if (pcpu->fparea != fpu || fpu->cpu != &pcpu->cpu) {
+    riscv_fpu_restore(fpu);
+    pcpu->fparea = fpu;
+    fpu->cpu = &pcpu->cpu;
+  }
+  pcpu->fpused = 1;
+  return 1;
+}
+#endif
+
+/* FPUArea.cpu is set at the first F/D instruction of the task. */
+int port_usedfpu(const Task *task) {
+#ifdef __riscv_flen
+  return getfpu(task)->cpu != NULL;
+#else
+  return 0;
+#endif
+}
+
 void theexc(Lib *lib, struct fullframe *ff) {
   ExecCPU *cpu;
 
+#ifdef __riscv_flen
+  if (ff->scause == RISCV_EXCEPTION_ILLEGAL_INSTRUCTION &&
+   fputrap(lib)) {
+    /* Execute it again with FS on. */
+    return;
+  }
+#endif
   cpu = port_get_cpu();
   if (cpu->isr_nest == 0 && cpu->switch_disable == 0) {
     Task *task;
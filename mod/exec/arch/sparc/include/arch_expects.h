@@ -8,4 +8,6 @@ void any_interrupt(
 );
 
 void sparc_sync_instructions(void);
+/* start the counter read by port_get_timestamp(), see chip */
+void sparc_init_timestamp(void);
 
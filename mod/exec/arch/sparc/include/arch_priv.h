@@ -17,6 +17,7 @@
  *
  * g5: nwinmin1
  * g6: PortCPU
+ * g7: running Task, set by port_switch_tasks()
  */
 
 /* Stacked on interrupt entry. */
@@ -50,12 +51,21 @@ struct TaskArch {
   unsigned int o7;  /* return pc */
 };
 
+/* FPU registers of a task, above its initial TaskArch. */
+struct FPUArea {
+  unsigned int f[32];
+  unsigned int fsr;
+  ExecCPU *cpu;         /* registers of this CPU hold the state */
+};
+
 void kcstart(void *ramtop, unsigned long id);
 void kprint_cpu(Lib *lib);
 void theexc(Lib *lib, struct fullframe *ff);
 
 /* Only useful for IMPL and VER */
 unsigned int get_psr(void);
+/* Load the FPU registers. Return 0 if there is no FPU. */
+int sparc_fpu_restore(const struct FPUArea *fpu);
 
 #define LINKER_SYMBOL(sym) extern char sym [];
 
@@ -64,6 +64,12 @@ STRUCTDEF taskarch
         INT     o7
 ENDSTRUCT
 
+STRUCTDEF fpuarea
+        ARRAY   128 f
+        INT     fsr
+        ADDR    cpu
+ENDSTRUCT
+
 STRUCTDEF Node
         ADDR    succ
         ADDR    pred
@@ -88,6 +94,12 @@ STRUCTDEF PortCPU
         ADDR    removing
         ADDR    heir
         ADDR    idle
+        LONG    rcuepoch
+        ADDR    softint_head
+        ADDR    softint_tail
+        ADDR    softint_tailpred
+        ADDR    fparea
+        LONG    fpused
         ARRAY   8 ipi_command
         STRUCT  intframe tmpstack_intframe
         ARRAY   64 tmpstack_il
@@ -20,3 +20,5 @@
 #define TBR_TBA       0xfffff000
 #define TBR_TT        0x00000ff0
 
+#define TT_FP_DISABLED 0x04
+
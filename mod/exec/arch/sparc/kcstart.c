@@ -27,6 +27,10 @@ static struct {
 
 struct PortCPU {
   ExecCPU cpu;
+  /* FPU registers hold this state, see fputrap(). */
+  struct FPUArea *fparea;
+  /* The running task has PSR.EF set. */
+  unsigned long fpused;
   char ipi_command[8];
   /* Set as sp in port_switch_tasks() when no task assigned to CPU. */
   struct {
@@ -45,8 +49,10 @@ void kcstart(void *ramtop, unsigned long id) {
   Lib *const lib = &theexecbase.lib;
   AbsExecBase = lib;
   iRawIOInit(lib);
+  sparc_init_timestamp();
   initlib(lib);
-  lib->minstack = 8 * 1024;
+  /* Only the outermost interrupt frame lands on a task stack. */
+  lib->minstack = 2 * 1024;
   lib->trapcode = default_trapcode;
   tasklockp = &lib->tasklock;
 
@@ -70,24 +76,92 @@ extern char trampo;
 
 void port_prepstack(Lib *lib, Task *task) {
   TaskArch *arch;
+  struct FPUArea *fpu;
 
-  arch = (TaskArch *) ((unsigned) task->spupper & ~7U);
+  fpu = (struct FPUArea *) ((unsigned) task->spupper & ~7U);
+  fpu--;
+  /* FSR 0 as required by the SPARC ABI */
+  *fpu = (struct FPUArea) { 0 };
+  arch = (TaskArch *) fpu;
   arch--;
   task->spupper = arch;
   *arch = (TaskArch) { 0 };
   /* %fp=0 marks deepest stack frame in SPARC ABI, Chapter 3 */
   arch->o7 = (unsigned int) &trampo - 8;
-  arch->psr = PSR_EF | PSR_PS;
+  arch->psr = PSR_PS;
   task->arch = arch;
   /* SPARC ABI allocates stack it may never use */
   task->canaries.num = 96/4 + 5;
 }
 
+static void costart(void) {
+  coentry(AbsExecBase);
+}
+
+/* The TaskArch is at the bottom of the first stack frame. */
+void *port_coprep(void *top) {
+  TaskArch *arch;
+
+  arch = (TaskArch *) (((unsigned) top & ~7U) - 96);
+  *arch = (TaskArch) { 0 };
+  arch->o7 = (unsigned int) &costart - 8;
+  return arch;
+}
+
 int port_interrupt_is_enabled(int level) {
   return (level & 0xf00) == 0;
 }
 
+/* The FPUArea is above the initial TaskArch. */
+static struct FPUArea *getfpu(const Task *task) {
+  return (struct FPUArea *) ((TaskArch *) task->spupper + 1);
+}
+
+/*
+ * Tasks are switched to with PSR.EF clear and the first FPU
+ * instruction gives fp_disabled. The registers are loaded unless
+ * they hold the state of the task already, which is when no other
+ * task used the FPU on this CPU since and the task did not use it
+ * on another CPU. port_switch_tasks() writes the registers back
+ * if fpused is set, since the task may continue on another CPU.
+ * This replaces saving the FPU on the task stack at every
+ * preemption.
+ *
+ * Interrupt handlers run with PSR.EF clear and shall not use the
+ * FPU.
+ */
+static int fputrap(Lib *lib, struct fullframe *ff) {
+  struct PortCPU *pcpu;
+  struct FPUArea *fpu;
+
+  pcpu = (struct PortCPU *) port_get_cpu();
+  if (pcpu->cpu.isr_nest != 0) {
+    return 0;
+  }
+  fpu = getfpu(port_ThisTask(lib));
+  if (pcpu->fparea != fpu || fpu->cpu != &pcpu->cpu) {
+    if (!sparc_fpu_restore(fpu)) {
+      return 0;
+    }
+    pcpu->fparea = fpu;
+    fpu->cpu = &pcpu->cpu;
+  }
+  pcpu->fpused = 1;
+  ff->psr |= PSR_EF;
+  return 1;
+}
+
+/* FPUArea.cpu is set at the first FPU instruction of the task. */
+int port_usedfpu(const Task *task) {
+  return getfpu(task)->cpu != NULL;
+}
+
 void theexc(Lib *lib, struct fullframe *ff) {
+  if (((ff->tbr & TBR_TT) >> TBR_TT_BIT) == TT_FP_DISABLED &&
+   fputrap(lib, ff)) {
+    /* Execute it again with PSR.EF set. */
+    return;
+  }
   if ((ff->psr & PSR_PS) == 0) {
     Task *task;
 
@@ -0,0 +1,119 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Atomic operations, single processor version */
+
+#include <priv.h>
+#include <port.h>
+
+/*
+ * The operations are made indivisible by disabling interrupts.
+ * The function calls order memory accesses for the compiler and a
+ * single processor needs nothing more.
+ */
+
+unsigned int iAtomicCompareSwap(
+  Lib *lib,
+  volatile unsigned int *p,
+  unsigned int old,
+  unsigned int new
+) {
+  unsigned int ret;
+  int level;
+
+  level = port_disable_interrupts();
+  ret = *p;
+  if (ret == old) {
+    *p = new;
+  }
+  port_enable_interrupts(level);
+  return ret;
+}
+
+void *iAtomicCompareSwapPtr(
+  Lib *lib,
+  void *volatile *p,
+  void *old,
+  void *new
+) {
+  void *ret;
+  int level;
+
+  level = port_disable_interrupts();
+  ret = *p;
+  if (ret == old) {
+    *p = new;
+  }
+  port_enable_interrupts(level);
+  return ret;
+}
+
+unsigned int iAtomicSwap(Lib *lib, volatile unsigned int *p,
+ unsigned int val) {
+  unsigned int ret;
+  int level;
+
+  level = port_disable_interrupts();
+  ret = *p;
+  *p = val;
+  port_enable_interrupts(level);
+  return ret;
+}
+
+void *iAtomicSwapPtr(Lib *lib, void *volatile *p, void *val) {
+  void *ret;
+  int level;
+
+  level = port_disable_interrupts();
+  ret = *p;
+  *p = val;
+  port_enable_interrupts(level);
+  return ret;
+}
+
+unsigned int iAtomicAdd(Lib *lib, volatile unsigned int *p,
+ unsigned int val) {
+  unsigned int ret;
+  int level;
+
+  level = port_disable_interrupts();
+  ret = *p;
+  *p = ret + val;
+  port_enable_interrupts(level);
+  return ret;
+}
+
+unsigned int iAtomicAnd(Lib *lib, volatile unsigned int *p,
+ unsigned int val) {
+  unsigned int ret;
+  int level;
+
+  level = port_disable_interrupts();
+  ret = *p;
+  *p = ret & val;
+  port_enable_interrupts(level);
+  return ret;
+}
+
+unsigned int iAtomicOr(Lib *lib, volatile unsigned int *p,
+ unsigned int val) {
+  unsigned int ret;
+  int level;
+
+  level = port_disable_interrupts();
+  ret = *p;
+  *p = ret | val;
+  port_enable_interrupts(level);
+  return ret;
+}
+
+void iAtomicAcquire(Lib *lib) {
+}
+
+void iAtomicRelease(Lib *lib) {
+}
+
+void iAtomicFence(Lib *lib) {
+  port_memory_barrier();
+}
+
@@ -0,0 +1,139 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Big-reader IntLock, SMP version */
+
+#include <stdint.h>
+#include <priv.h>
+#include <port.h>
+#include <exec/atomic.h>
+
+/*
+ * Each CPU has a reader count in its own cache line. A reader
+ * increments the local count and then checks for a writer. A
+ * writer sets the writer word to its CPU id + 1 and then waits for
+ * all counts to become zero. Both sides do a full memory barrier
+ * in between so that at least one of them observes the other.
+ *
+ * A reader can be interrupted by a nested reader on the same CPU.
+ * Only the first reader on a CPU backs off for a writer: nested
+ * readers must proceed since the writer is waiting for the
+ * interrupted reader.
+ *
+ * Readers take one switch_disable level, as ObtainRCU() does, so
+ * that the reader count is released on the same CPU as it was
+ * obtained. A reader which backs off gives the level back with
+ * switch_enable(), so a pending task switch is done, and starts
+ * over on whatever CPU it then runs on.
+ *
+ * A writer spins with interrupts enabled while another writer
+ * holds the lock. Once it owns the writer word it keeps local
+ * interrupts disabled: an interrupt handler reading the lock on
+ * the writer CPU would otherwise wait for the writer forever.
+ */
+
+static size_t brlock_size(int ncpu) {
+  /* room for aligning the slots to BRLOCK_SLOTSIZE */
+  return sizeof (BRLock) + (ncpu + 1) * sizeof (BRLockSlot);
+}
+
+BRLock *iCreateBRLock(Lib *lib) {
+  BRLock *lock;
+  int ncpu;
+
+  ncpu = port_get_ncpu(lib);
+  lock = lAllocMem(lib, brlock_size(ncpu), MEMF_CLEAR | MEMF_ANY);
+  if (lock == NULL) {
+    return NULL;
+  }
+  lock->writer = 0;
+  lock->ncpu = ncpu;
+  lock->slot = (BRLockSlot *) (
+    ((uintptr_t) (lock + 1) + (BRLOCK_SLOTSIZE - 1)) &
+    ~(uintptr_t) (BRLOCK_SLOTSIZE - 1)
+  );
+  return lock;
+}
+
+void iDeleteBRLock(Lib *lib, BRLock *lock) {
+  if (lock == NULL) {
+    return;
+  }
+  lFreeMem(lib, lock, brlock_size(lock->ncpu));
+}
+
+void iObtainBRLockShared(Lib *lib, BRLock *lock) {
+  ExecCPU *cpu;
+  BRLockSlot *slot;
+  int level;
+
+  level = port_disable_interrupts();
+  while (1) {
+    cpu = port_get_cpu();
+    KASSERT(cpu->id < (unsigned long) lock->ncpu);
+    cpu->switch_disable++;
+    slot = &lock->slot[cpu->id];
+    slot->readers++;
+    port_memory_barrier();
+    if (lock->writer == 0 || slot->readers != 1) {
+      break;
+    }
+    /* First reader on this CPU: let the writer complete. */
+    slot->readers--;
+    switch_enable(lib, cpu, level);
+    port_enable_interrupts(level);
+    while (lock->writer) {
+      ;
+    }
+    level = port_disable_interrupts();
+  }
+  port_enable_interrupts(level);
+}
+
+void iObtainBRLock(Lib *lib, BRLock *lock) {
+  AtomicInteger self;
+  int level;
+
+  level = port_disable_interrupts();
+  self = port_get_cpu()->id + 1;
+  while (atomic_cas(lib, &lock->writer, 0, self) != 0) {
+    port_enable_interrupts(level);
+    while (lock->writer) {
+      ;
+    }
+    level = port_disable_interrupts();
+    self = port_get_cpu()->id + 1;
+  }
+  lock->plevel = level;
+  /* The compare-and-swap was a full barrier. */
+  for (int i = 0; i < lock->ncpu; i++) {
+    while (lock->slot[i].readers) {
+      ;
+    }
+  }
+  port_memory_barrier();
+}
+
+void iReleaseBRLock(Lib *lib, BRLock *lock) {
+  ExecCPU *cpu;
+  BRLockSlot *slot;
+  int level;
+
+  port_memory_barrier();
+  level = port_disable_interrupts();
+  cpu = port_get_cpu();
+  slot = &lock->slot[cpu->id];
+  if (slot->readers == 0) {
+    /* Readers are locked out so this CPU is the writer. */
+    KASSERT(lock->writer == cpu->id + 1);
+    level = lock->plevel;
+    lock->writer = 0;
+    port_enable_interrupts(level);
+    return;
+  }
+
+  slot->readers--;
+  switch_enable(lib, cpu, level);
+  port_enable_interrupts(level);
+}
+
@@ -0,0 +1,54 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Big-reader IntLock, single processor version */
+
+#include <priv.h>
+#include <port.h>
+
+/*
+ * There is one CPU so readers and writers disable interrupts.
+ * Readers may nest, so writer counts the holders and the level of
+ * the first one is restored by the last release.
+ */
+
+BRLock *iCreateBRLock(Lib *lib) {
+  BRLock *lock;
+
+  lock = lAllocMem(lib, sizeof *lock, MEMF_CLEAR | MEMF_ANY);
+  if (lock == NULL) {
+    return NULL;
+  }
+  lock->writer = 0;
+  lock->ncpu = 1;
+  lock->slot = NULL;
+  return lock;
+}
+
+void iDeleteBRLock(Lib *lib, BRLock *lock) {
+  if (lock == NULL) {
+    return;
+  }
+  lFreeMem(lib, lock, sizeof *lock);
+}
+
+void iObtainBRLockShared(Lib *lib, BRLock *lock) {
+  int level;
+
+  level = port_disable_interrupts();
+  if (lock->writer++ == 0) {
+    lock->plevel = level;
+  }
+}
+
+void iObtainBRLock(Lib *lib, BRLock *lock) {
+  iObtainBRLockShared(lib, lock);
+}
+
+void iReleaseBRLock(Lib *lib, BRLock *lock) {
+  KASSERT(lock->writer);
+  if (--lock->writer == 0) {
+    port_enable_interrupts(lock->plevel);
+  }
+}
+
@@ -135,7 +135,7 @@ void any_interrupt(Lib *lib, unsigned int cpunum) {
   local_source = bcm2836_regs->core_irq_source[cpunum] & 0xfff;
   if (local_source & CORE_IRQ_SOURCE_MBOX3) {
     bcm2836_regs->core_mailbox_read[cpunum][3] = 0xffffffff;
-    announce_ipi();
+    announce_ipi(lib);
   }
   local_source &= ~CORE_IRQ_SOURCE_MBOX3;
   if (cpunum != 0) {
@@ -115,7 +115,7 @@ void any_interrupt(Lib *lib, char *ipi_command, unsigned int tbr) {
       sparc_sync_instructions();
     }
     /* FIXME: also condition this on a "command" */
-    announce_ipi();
+    announce_ipi(lib);
     return;
   }
   eirq = get_eirq();
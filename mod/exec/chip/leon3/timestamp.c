@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/*
+ * port_get_timestamp() reads a GPTIMER timer which is set to count
+ * down from 0xffffffff forever. All CPUs read the same timer, at
+ * the rate the boot loader has set for the prescaler, typically
+ * 1 MHz. The LEON up-counter (%asr22, %asr23) would be faster to
+ * read but it is optional.
+ *
+ * The first timer is left to the boot loader and to a clock driver,
+ * the second one is used when there is one.
+ */
+
+#include <priv.h>
+#include <port.h>
+#include <arch_expects.h>
+
+struct subtimer {
+  unsigned count;
+  unsigned reload;
+  unsigned ctrl;
+  unsigned latch;
+};
+
+#define GPTIMER_CTRL_LD   (1U <<  2)
+#define GPTIMER_CTRL_RS   (1U <<  1)
+#define GPTIMER_CTRL_EN   (1U <<  0)
+
+struct gptimer_regs {
+  unsigned scaler;
+  unsigned reload;
+  unsigned cfg;
+  unsigned latchcfg;
+  struct subtimer sub[7];
+};
+
+/* FIXME: the gptimer address assumption */
+static volatile struct gptimer_regs *const regs =
+ (void *) 0x80000300;
+
+static volatile struct subtimer *timer;
+
+/* This is called only from the boot CPU, before any timestamp. */
+void sparc_init_timestamp(void) {
+  timer = &regs->sub[1 < (regs->cfg & 7) ? 1 : 0];
+  timer->ctrl = 0;
+  timer->reload = 0xffffffff;
+  timer->ctrl = GPTIMER_CTRL_LD | GPTIMER_CTRL_RS | GPTIMER_CTRL_EN;
+}
+
+unsigned long port_get_timestamp(void) {
+  return ~timer->count;
+}
+
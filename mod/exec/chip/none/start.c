@@ -62,7 +62,11 @@ void *kcstart(void) {
   initlib(lib);
   lib->minstack = 256;
   addmem0(lib, &_addmem_bottom, &_addmem_top);
-  /* TODO: Initialize exceptions */
+  /*
+   * TODO: Initialize exceptions. The outermost interrupt entry
+   * (isr_nest 0) should switch to a dedicated interrupt stack so
+   * that task stacks only hold one interrupt frame.
+   */
   collectres(lib, _romtag_begin, _romtag_end);
 
   /* Task switching should not be activated yet. */
@@ -89,6 +93,38 @@ void port_prepstack(Lib *lib, Task *task) {
   task->canaries.num = 3;
 }
 
+static void costart(void) {
+  coentry(AbsExecBase);
+}
+
+/*
+ * port_coswitch() is typically implemented in assembly. It saves
+ * the callee-saved registers and return address on the stack and
+ * loads them from the other stack.
+ */
+void port_coswitch(void **save, void *sp, int fpu) {
+  /* TODO: push callee-saved registers and lr */
+  /* TODO: also callee-saved FPU registers if fpu */
+  /* TODO: *save = sp register; sp register = sp */
+  (void) save;
+  (void) sp;
+  /* TODO: pop callee-saved registers and return */
+}
+
+int port_usedfpu(const Task *task) {
+  return 0;
+}
+
+/* return: context which port_coswitch() continues in costart() */
+void *port_coprep(void *top) {
+  TaskArch *arch;
+
+  arch = (TaskArch *) ((uintptr_t) top & ~7U);
+  arch--;
+  arch->lr = (unsigned) costart;
+  return arch;
+}
+
 Task *port_ThisTask(Lib *lib) {
   KASSERT(priv.ThisTask);
   return priv.ThisTask;
@@ -101,6 +137,22 @@ void port_halt(void) {
   }
 }
 
+/* A single processor without store buffers needs no barrier. */
+void port_memory_barrier(void) {
+}
+
+unsigned long port_get_timestamp(void) {
+  return 0;
+}
+
+int port_get_ncpu(Lib *lib) {
+  return 1;
+}
+
+void port_raise_softint(void) {
+  /* TODO: pend a low priority exception which calls runsoftints() */
+}
+
 void task_entry(Lib *lib) {
   KASSERT(priv.ThisTask);
   KASSERT(priv.ThisTask->init);
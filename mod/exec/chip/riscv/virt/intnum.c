@@ -95,7 +95,7 @@ void any_interrupt(Lib *lib, ExecCPU *cpu, unsigned long scause) {
   if (scause == RISCV_INTERRUPT_SOFTWARE_SUPERVISOR) {
     /* Clear pending software interrupts on local CPU. */
     riscv_csrc_sip(RISCV_SIP_SSIP);
-    announce_ipi();
+    announce_ipi(lib);
   } else if (scause == RISCV_INTERRUPT_TIMER_SUPERVISOR) {
     runintservers(lib, 0);
   } else if (scause == RISCV_INTERRUPT_EXTERNAL_SUPERVISOR) {
@@ -0,0 +1,168 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Coroutines inside a task */
+
+#include <priv.h>
+#include <port.h>
+
+/*
+ * A Coroutine runs on its own stack in the task which resumes it.
+ * port_coswitch() saves the callee-saved registers of one context
+ * on its stack and continues with the other. This involves neither
+ * the scheduler nor tasklock. The task may still be switched out
+ * or move to another CPU in between, like with any call.
+ *
+ * Task.coroutine is the running Coroutine. ResumeCoroutine() keeps
+ * the previous one on its stack, so coroutines may resume others.
+ *
+ * The FPU registers are left alone until the task has used the
+ * FPU. Touching them before would make an integer-only task take
+ * the lazy FPU trap, and then pay for the FPU at each task switch.
+ * Contexts saved before the first FPU use had no FPU state to keep.
+ */
+
+enum {
+  CS_READY,
+  CS_RUNNING,
+  CS_DONE,
+};
+
+static void coswitch(Lib *lib, void **save, void *sp) {
+  port_coswitch(save, sp, port_usedfpu(port_ThisTask(lib)));
+}
+
+void coentry(Lib *lib) {
+  Coroutine *co;
+
+  co = port_ThisTask(lib)->coroutine;
+  co->code(lib, co);
+  co->state = CS_DONE;
+  coswitch(lib, &co->sp, co->caller);
+  lAlert(lib, AT_DeadEnd | AN_ExecLib | AG_Panic);
+}
+
+Coroutine *iCreateCoroutine(
+  Lib *lib,
+  char *name,
+  void (*code)(Lib *lib, Coroutine *co),
+  void *user,
+  size_t stacksize
+) {
+  Coroutine *co;
+  size_t memsize;
+
+  memsize = sizeof *co + stacksize;
+  co = lAllocMem(lib, memsize, MEMF_ANY);
+  if (co == NULL) {
+    return NULL;
+  }
+  lMemSet(lib, co, 0, sizeof *co);
+  co->node.name = name;
+  co->code = code;
+  co->user = user;
+  co->memsize = memsize;
+  co->state = CS_READY;
+  co->sp = port_coprep((char *) co + memsize);
+  return co;
+}
+
+void iDeleteCoroutine(Lib *lib, Coroutine *co) {
+  if (co == NULL) {
+    return;
+  }
+  KASSERT(co->state != CS_RUNNING);
+  lFreeMem(lib, co, co->memsize);
+}
+
+int iResumeCoroutine(Lib *lib, Coroutine *co) {
+  Task *task;
+  Coroutine *prev;
+
+  KASSERT(co->state == CS_READY);
+  task = port_ThisTask(lib);
+  prev = task->coroutine;
+  task->coroutine = co;
+  co->state = CS_RUNNING;
+  coswitch(lib, &co->caller, co->sp);
+  task->coroutine = prev;
+  if (co->state == CS_DONE) {
+    return 0;
+  }
+  co->state = CS_READY;
+  return 1;
+}
+
+void iYieldCoroutine(Lib *lib) {
+  Coroutine *co;
+
+  co = port_ThisTask(lib)->coroutine;
+  KASSERT(co);
+  coswitch(lib, &co->sp, co->caller);
+}
+
+unsigned int iAwaitCoroutine(Lib *lib, unsigned int sigmask) {
+  Coroutine *co;
+
+  co = port_ThisTask(lib)->coroutine;
+  if (co == NULL) {
+    return lWait(lib, sigmask);
+  }
+  co->sigwait = sigmask;
+  co->signals = 0;
+  while (co->signals == 0) {
+    coswitch(lib, &co->sp, co->caller);
+  }
+  co->sigwait = 0;
+  return co->signals;
+}
+
+/* not waiting, or woken up in AwaitCoroutine() */
+static int isready(const Coroutine *co) {
+  return co->sigwait == 0 || co->signals != 0;
+}
+
+void iRunCoroutines(Lib *lib, List *list) {
+  Coroutine *co;
+  Node *node;
+  Node *next;
+
+  while (list->head->succ) {
+    unsigned int sigmask;
+    unsigned int got;
+    int ready;
+
+    for (node = list->head; (next = node->succ); node = next) {
+      co = (Coroutine *) node;
+      if (isready(co) && !lResumeCoroutine(lib, co)) {
+        iRemove(lib, node);
+      }
+    }
+    sigmask = 0;
+    ready = 0;
+    for (node = list->head; node->succ; node = node->succ) {
+      co = (Coroutine *) node;
+      if (isready(co)) {
+        ready = 1;
+      } else {
+        sigmask |= co->sigwait;
+      }
+    }
+    if (sigmask == 0) {
+      continue;
+    }
+    /* Only sleep if no coroutine can run. */
+    if (ready) {
+      got = lClearSignal(lib, sigmask) & sigmask;
+    } else {
+      got = lWait(lib, sigmask);
+    }
+    for (node = list->head; node->succ; node = node->succ) {
+      co = (Coroutine *) node;
+      if (!isready(co)) {
+        co->signals = co->sigwait & got;
+      }
+    }
+  }
+}
+
@@ -3,6 +3,73 @@
 
 #include <priv.h>
 
+enum {
+  /* Task and stack pairs kept after their tasks have ended */
+  TASKCACHE_MAX = 8,
+};
+
+/* Name of the MemList holding the Task and stack, see cachetask(). */
+static const char taskmem[] = "taskmem";
+
+/* Task and stack with exactly stacksize bytes of stack */
+static MemList *takecached(Lib *lib, size_t stacksize) {
+  MemList *ml;
+
+  ml = NULL;
+  lObtainIntLock(lib, &lib->taskcachelock);
+  for (Node *node = lib->taskcache.head; node->succ;
+   node = node->succ) {
+    if (((MemList *) node)->entry[1].size == stacksize) {
+      iRemove(lib, node);
+      lib->ntaskcache--;
+      ml = (MemList *) node;
+      break;
+    }
+  }
+  lReleaseIntLock(lib, &lib->taskcachelock);
+  return ml;
+}
+
+int flushtaskcache(Lib *lib) {
+  List tmplist;
+  Node *node;
+  int n;
+
+  iNewList(lib, &tmplist);
+  lObtainIntLock(lib, &lib->taskcachelock);
+  movelist(lib, &tmplist, &lib->taskcache);
+  n = lib->ntaskcache;
+  lib->ntaskcache = 0;
+  lReleaseIntLock(lib, &lib->taskcachelock);
+  while ((node = iRemHead(lib, &tmplist))) {
+    lFreeEntry(lib, (MemList *) node);
+  }
+  return n != 0;
+}
+
+int cachetask(Lib *lib, MemList *ml) {
+  int ok;
+
+  if (ml->node.name != taskmem) {
+    return 0;
+  }
+  ok = 0;
+  lObtainIntLock(lib, &lib->taskcachelock);
+  if (lib->ntaskcache < TASKCACHE_MAX) {
+    iAddHead(lib, &lib->taskcache, &ml->node);
+    lib->ntaskcache++;
+    ok = 1;
+  }
+  lReleaseIntLock(lib, &lib->taskcachelock);
+  return ok;
+}
+
+/*
+ * The Task and stack come from the cache if a task with the same
+ * stack size has ended, else from AllocEntry(). Only the Task is
+ * cleared on reuse. AllocMem() empties the cache when it runs out
+ * of memory, see flushtaskcache().
+ */
 Task *iCreateTask(
   Lib *lib,
   char *name,
@@ -19,13 +86,19 @@ Task *iCreateTask(
   if (stacksize < lib->minstack) {
     stacksize = lib->minstack;
   }
-  req[0].attr = MEMF_CLEAR | MEMF_ANY;
-  req[0].size = sizeof (Task);
-  req[1].attr = MEMF_ANY;
-  req[1].size = stacksize;
-  ml = lAllocEntry(lib, req, NELEM(req));
-  if (ml == NULL) {
-    return NULL;
+  ml = takecached(lib, stacksize);
+  if (ml) {
+    lMemSet(lib, ml->entry[0].ptr, 0, sizeof (Task));
+  } else {
+    req[0].attr = MEMF_CLEAR | MEMF_ANY;
+    req[0].size = sizeof (Task);
+    req[1].attr = MEMF_ANY;
+    req[1].size = stacksize;
+    ml = lAllocEntry(lib, req, NELEM(req));
+    if (ml == NULL) {
+      return NULL;
+    }
+    ml->node.name = (char *) taskmem;
   }
 
   Task *task = ml->entry[0].ptr;
@@ -24,12 +24,13 @@ int iOpenDevice(
 ) {
   Device *d;
   int callexpunge;
-  lObtainMutex(lib, &lib->devlock);
+
+  lObtainRCU(lib);
   d = (Device *) lFindName(lib, &lib->devlist, name);
-  if (d) {
-    d->lib.opencount++;
+  if (d && incopen(lib, &d->lib) == 0) {
+    d = NULL;
   }
-  lReleaseMutex(lib, &lib->devlock);
+  lReleaseRCU(lib);
 
   ior->device = d;
   if (d == NULL) {
@@ -40,18 +41,8 @@ int iOpenDevice(
   ior->error = IOERR_OK;
   GETOP(d)->Open(d, ior, unitnum);
 
-  callexpunge = 0;
-  lObtainMutex(lib, &lib->devlock);
-  if (ior->error == IOERR_OK) {
-    d->lib.flags &= ~LIBF_DELEXP;
-  } else {
-    d->lib.opencount--;
-    if (d->lib.opencount == 0 && d->lib.flags & LIBF_DELEXP) {
-      iRemove(lib, &d->lib.node);
-      callexpunge = 1;
-    }
-  }
-  lReleaseMutex(lib, &lib->devlock);
+  callexpunge = endopen(lib, &d->lib, &lib->devlock,
+   ior->error == IOERR_OK);
 
   if (callexpunge) {
     expungelib(lib, &d->lib);
@@ -67,14 +58,7 @@ void iCloseDevice(Lib *lib, IORequest *ior) {
   d = ior->device;
   GETOP(d)->Close(d, ior);
 
-  callexpunge = 0;
-  lObtainMutex(lib, &lib->devlock);
-  d->lib.opencount--;
-  if (d->lib.opencount == 0 && d->lib.flags & LIBF_DELEXP) {
-    iRemove(lib, &d->lib.node);
-    callexpunge = 1;
-  }
-  lReleaseMutex(lib, &lib->devlock);
+  callexpunge = decopen(lib, &d->lib, &lib->devlock);
 
   if (callexpunge) {
     expungelib(lib, &d->lib);
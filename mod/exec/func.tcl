@@ -8,13 +8,21 @@ mod_prefix      exec
 mod_header      stdarg.h
 mod_header      stddef.h
 
+mod_struct      BRLock
+mod_struct      Barrier
+mod_struct      Condition
+mod_struct      Coroutine
 mod_struct      Device
+mod_struct      EventFlags
 mod_struct      ExecBase
 mod_struct      IORequest
 mod_struct      IntList
 mod_struct      IntLock
+mod_struct      IntThread
 mod_struct      Interrupt
 mod_struct      Library
+mod_struct      LatencyStats
+mod_struct      LightTask
 mod_struct      List
 mod_struct      MemHeader
 mod_struct      MemList
@@ -23,14 +31,1145 @@ mod_struct      Message
 mod_struct      MsgPort
 mod_struct      Mutex
 mod_struct      Node
+mod_struct      RCUHead
 mod_struct      Resident
 mod_struct      ResidentAuto
 mod_struct      ResidentInfo
+mod_struct      Ring
 mod_struct      Segment
+mod_struct      Semaphore
 mod_struct      Task
+mod_struct      TaskStats
+mod_struct      Work
 
 # NOTE: Add new functions to the TOP of this file.
 
+func_begin      GetCPUCount
+func_return     "int"
+func_env        {isr}
+func_short      "get the number of processors"
+func_long       "
+Return the number of processors exec.library runs on, counting
+those which are not started yet. It does not change while the
+system runs, so it can size per-CPU data such as one worker task
+per processor.
+"
+func_result     "Number of processors, at least 1"
+func_see        "GetTimeStamp()"
+
+func_begin      ReportLatency
+func_return     "void"
+func_param      "void (*put)(void *arg, int c)" put isfunc
+func_param      "void *" arg
+func_short      "print the latency histograms"
+func_long       "
+Print each histogram of GetLatency() with its worst case and the
+non-empty buckets, formatted with RawDoFmt() to put(arg, c). The
+histograms keep recording while they are printed, so the bucket
+counts may add up to more than n.
+"
+func_see        "GetLatency(), ClearLatency()"
+
+func_begin      ClearLatency
+func_return     "void"
+func_short      "restart the latency histograms"
+func_long       "
+Clear all histograms of GetLatency(), for example after start-up
+or before a measurement.
+"
+func_see        "GetLatency()"
+
+func_begin      GetLatency
+func_return     "int"
+func_param      "int" kind
+func_param      "int" index
+func_param      "struct LatencyStats *" ls
+func_short      "read a scheduling latency histogram"
+func_long       "
+Copy a latency histogram to ls. The times are in GetTimeStamp()
+counts, in buckets by powers of two. The worst case names the
+task, the task which woke it or sent the IPI, and the task which
+ran on the CPU before.
+
+With kind LAT_WAKEUP, the latency is the time from when Signal()
+or any other wakeup makes a task ready, until the task runs. There
+is one histogram per priority of the woken tasks, and index 0, 1,
+... selects one of them. ls->pri tells the priority. Priorities
+seen after the histograms are used up are not recorded.
+
+With kind LAT_IPI, the latency is the time from when the
+scheduler sends an IPI to another CPU, until that CPU handles it.
+index shall be 0.
+
+Latencies across CPUs are only meaningful if the GetTimeStamp()
+counter is shared by all CPUs. The histograms are only recorded
+if exec.library is built with CFG_LATENCY 1, which can not be used
+on the ARMv6-M port since it has no such counter.
+"
+func_result     "1 if ls was written, 0 if no such histogram"
+func_see        "ReportLatency(), ClearLatency(), GetTaskStats()"
+
+func_begin      ReportTaskStats
+func_return     "void"
+func_param      "void (*put)(void *arg, int c)" put isfunc
+func_param      "void *" arg
+func_short      "print a table of task statistics"
+func_long       "
+Print one line per ready and waiting task, formatted with
+RawDoFmt() to put(arg, c). The columns are name, priority, state
+(R running, r ready, w waiting), percent of one CPU used since
+the previous call, run and ready time in thousands of counts,
+and the switch counts of TaskStats. Calling ReportTaskStats()
+periodically gives a top-like view. The idle tasks show the idle
+time of each CPU.
+
+The tasks are copied a few at a time under the task list lock
+and printed after it is released, so put may be slow and may call
+exec.library. A task which is added or ends during the report may
+be missed or shown twice. The buffer is allocated with AllocMem()
+and nothing is printed if that fails.
+"
+func_see        "GetTaskStats()"
+
+func_begin      GetTaskStats
+func_return     "void"
+func_param      "struct Task *" task
+func_param      "struct TaskStats *" stats
+func_short      "get CPU time and switch counts of a task"
+func_long       "
+Copy the statistics of task to stats. The times are in
+GetTimeStamp() counts and include the current period, if task is
+ready or running. runtime is the time task has run on a CPU.
+readytime is the time it has been ready without running, so
+divided by nswitch it is the mean wait for a CPU.
+
+nvoluntary counts switches to wait or end. ninvoluntary counts
+switches while still ready, by preemption or Yield().
+
+The statistics cost two counter reads per task switch and take
+no lock. They are zero if exec.library is built with CFG_TASKSTATS
+0, the default. CFG_TASKSTATS 1 needs a GetTimeStamp() counter,
+so it can not be used on the ARMv6-M port.
+"
+func_see        "ReportTaskStats(), GetTimeStamp()"
+
+func_begin      Yield
+func_return     "void"
+func_short      "let ready tasks of the same priority run"
+func_long       "
+Put the calling task behind the other ready tasks with the same
+priority and switch to the first of them which is not running on
+another CPU. If there is no such task, Yield() returns at once
+without a scheduling pass over all CPUs.
+
+Switch() does not help here, since the scheduler keeps a running
+task on its CPU. Must be called from task context.
+"
+func_see        "Switch(), SetTaskPri()"
+
+func_begin      CreateCoroutine
+func_return     "struct Coroutine *"
+func_param      "char *" name
+func_param      "void (*code)(struct ExecBase *lib, struct Coroutine *co)" code isfunc
+func_param      "void *" user
+func_param      "size_t" stacksize
+func_short      "create a coroutine"
+func_long       "
+Create a coroutine which calls code(lib, co) with a stack of
+stacksize bytes when it is resumed the first time. The stack has
+no minimum size, but it must hold the deepest calls made by code
+and the registers saved at a coroutine switch.
+
+A coroutine runs inside the task which resumes it. Switching
+between coroutines saves and restores registers on the same CPU
+and involves neither the task scheduler nor any lock.
+"
+func_result     "the coroutine, or NULL if out of memory"
+func_see        "DeleteCoroutine(), ResumeCoroutine()"
+
+func_begin      DeleteCoroutine
+func_return     "void"
+func_param      "struct Coroutine *" co
+func_short      "delete a coroutine"
+func_long       "
+Free the memory of co. co may have ended or not have been resumed
+at all. It may also be suspended in YieldCoroutine() or
+AwaitCoroutine(), in which case its code never continues. It
+shall not be running. co may be NULL.
+"
+func_see        "CreateCoroutine()"
+
+func_begin      ResumeCoroutine
+func_return     "int"
+func_param      "struct Coroutine *" co
+func_short      "run a coroutine until it yields"
+func_long       "
+Continue co where it last yielded, or start it. ResumeCoroutine()
+returns when co calls YieldCoroutine() or AwaitCoroutine(), or
+when its code returns. The task itself or another coroutine of
+the same task may resume co.
+"
+func_result     "1 if co can be resumed again, 0 if it has ended"
+func_see        "YieldCoroutine(), RunCoroutines()"
+
+func_begin      YieldCoroutine
+func_return     "void"
+func_short      "return to the resumer of the coroutine"
+func_long       "
+Suspend the calling coroutine and continue after the
+ResumeCoroutine() which started or continued it. Shall only be
+called by a coroutine.
+"
+func_see        "ResumeCoroutine(), AwaitCoroutine()"
+
+func_begin      AwaitCoroutine
+func_return     "unsigned int"
+func_param      "unsigned int" sigmask
+func_short      "wait for signals in a coroutine"
+func_long       "
+Wait for any of the signals in sigmask of the task, like Wait().
+A coroutine run by RunCoroutines() yields until one of them is
+received, so the other coroutines of the task continue. Called
+by the task itself, this is Wait().
+
+The signals are allocated with AllocSignal() as usual, also
+implicitly by CreateMsgPort() in a coroutine. So a coroutine
+waits for a message with AwaitCoroutine(1U << port->sigbit).
+"
+func_result     "the received signals in sigmask, which are cleared"
+func_see        "RunCoroutines(), Wait()"
+
+func_begin      RunCoroutines
+func_return     "void"
+func_param      "struct List *" list
+func_short      "run coroutines until all have ended"
+func_long       "
+Resume the coroutines on list in turn, with the coroutines linked
+by their node. A coroutine which has yielded is resumed again in
+the next round. One in AwaitCoroutine() is resumed after one of
+its signals has been received. The calling task only Wait()s when
+all the coroutines wait. A coroutine is removed from list when it
+ends, and RunCoroutines() returns when list is empty.
+"
+func_see        "AwaitCoroutine(), ResumeCoroutine()"
+
+func_begin      AddLightTask
+func_return     "void"
+func_param      "struct LightTask *" lt
+func_short      "start a lightweight task"
+func_long       "
+Start a task which has no stack of its own. lt->code() is run by
+a work queue on the stack of the worker task, see QueueWork() for
+its size, and it runs to completion each time it is called. It
+returns the set of signals to wait for, LIGHTF_YIELD to be run
+again after other queued work, or 0 when it has ended. When called
+after a wait, lt->signals holds the signals which were received,
+and these are cleared.
+
+lt->code() may call functions allowed in a task which do not
+block, such as GetMsg(), PutMsg(), ReplyMsg() and
+ReleaseSemaphore(). Blocking stalls the other work of the CPU.
+The LT_BEGIN(), LT_WAIT(), LT_YIELD() and LT_END() macros make
+code() continue where it returned.
+
+The signal bits of a LightTask are separate from those of tasks
+and need no allocation, except for the bit of LIGHTF_YIELD. A
+MsgPort with sigtask NULL signals its siglight instead.
+
+The caller sets lt->code, and optionally lt->work.data and
+lt->work.node.name. lt may be added again after it has ended.
+"
+func_see        "SignalLightTask(), QueueWork()"
+
+func_begin      SignalLightTask
+func_return     "void"
+func_param      "struct LightTask *" lt
+func_param      "unsigned int" sigmask
+func_env        {isr}
+func_short      "signal a lightweight task"
+func_long       "
+Post the signals in sigmask to lt. If lt is waiting for any of
+them, it is queued to run. Other signals are recorded and wake
+lt up when it waits for them later.
+"
+func_see        "AddLightTask(), Signal()"
+
+func_begin      GetStackUsage
+func_return     "size_t"
+func_param      "struct Task *" task
+func_short      "get the deepest stack usage of a task"
+func_long       "
+Get the largest number of bytes task has used of its stack so
+far, including the initial context. It is found by searching for
+the deepest word which no longer holds the value written by
+AddTask().
+
+Stacks are only painted when exec.library is built with
+CFG_STACKPAINT set to 1, since it makes AddTask() touch the whole
+stack.
+"
+func_result     "stack bytes used, or 0 if stacks are not painted"
+func_see        "AddTask(), CreateTask()"
+
+func_begin      QueueWork
+func_return     "int"
+func_param      "struct Work *" work
+func_param      "int" cpu
+func_env        {isr}
+func_short      "queue work for a worker task"
+func_long       "
+Queue work to be run by the worker task of a CPU. The worker
+calls Work.code() with the library base and work as arguments.
+It may call any function which is allowed in a task, but other
+work on the same CPU waits until it returns. The worker stack is
+4 KiB, or ExecBase.minstack on ARMv6-M, unless exec.library is
+built with another CFG_WORKSTACK.
+
+If cpu is WORK_ANYCPU, the work is queued on the calling CPU.
+This is the cheap case since the queue lock is then only shared
+with the local worker. Otherwise the work is queued on CPU cpu,
+modulo the number of CPUs. The workers are not bound to their
+CPU, so cpu selects the queue, not where the code executes.
+
+work is taken off the queue just before Work.code() is called.
+From then on, it may be queued again, also by the code itself,
+or deallocated. Work.code() calls of a work queued on the same
+cpu never overlap.
+
+The caller initializes Work.code, and optionally Work.data and
+Work.node.name, and clears Work.queue before the first call.
+"
+func_result     "1 if work was queued, 0 if it was already queued"
+func_see        "CancelWork()"
+
+func_begin      CancelWork
+func_return     "int"
+func_param      "struct Work *" work
+func_short      "cancel queued work"
+func_long       "
+Remove work from its queue if it is queued. Then wait until no
+worker is running Work.code() for work, unless the caller is
+the worker itself.
+
+When this function returns, work may be deallocated if nobody
+queues it again.
+"
+func_result     "1 if work was removed from the queue, otherwise 0"
+func_see        "QueueWork()"
+
+func_begin      AddIntThread
+func_return     "struct Task *"
+func_param      "struct IntThread *" intthread
+func_param      "int" intnum
+func_param      "int" priority
+func_param      "size_t" stacksize
+func_short      "register a threaded interrupt handler"
+func_long       "
+Register a handler for interrupt intnum which runs in a task of
+its own instead of in interrupt context. This is for long
+handlers which would otherwise delay other interrupts.
+
+The caller initializes intthread->interrupt.code,
+intthread->interrupt.data and intthread->interrupt.node.name
+before the call. The name is also used for the task. A short
+interrupt server is added with AddIntServer(). When the interrupt
+occurs, it masks intnum with port_disable_intnum() and wakes the
+task, which has priority priority and a stack of stacksize
+bytes. The task calls Interrupt.code() with Interrupt.data as
+argument and then unmasks intnum.
+
+intnum stays masked while the handler runs, also for other
+servers sharing intnum, so the handler shall clear the interrupt
+condition in the device. The handler may call any function
+which is allowed in a task.
+"
+func_result     "the handler task, or NULL if it could not be created"
+func_see        "AddIntServer(), RemIntThread()"
+
+func_begin      RemIntThread
+func_return     "void"
+func_param      "struct IntThread *" intthread
+func_short      "unregister a threaded interrupt handler"
+func_long       "
+Remove a handler added with AddIntThread() and wait for its task
+to finish. A pending interrupt is handled before the task exits.
+intnum is masked if this was its last interrupt server.
+
+When this function returns, the IntThread structure may be reused
+or deallocated.
+"
+func_see        "AddIntThread()"
+
+func_begin      Cause
+func_return     "void"
+func_param      "struct Interrupt *" interrupt
+func_env        {isr}
+func_short      "queue a software interrupt"
+func_long       "
+Queue interrupt as a software interrupt on the calling CPU. The
+Interrupt.code() entry is called with Interrupt.data as argument
+when the outermost interrupt handler on the CPU returns, before
+any task continues. It runs in interrupt context but with
+interrupts enabled, so an interrupt handler can do the minimum
+work with the hardware and leave the rest, such as replying
+messages, to a software interrupt.
+
+Queued software interrupts run in order of Interrupt.node.pri,
+highest first, and in the order they were queued for equal
+priority. If interrupt is already queued then the call has no
+effect. Interrupt.node.type is NT_SOFTINT while it is queued. If
+called by a task, the software interrupt runs as soon as the
+task has interrupts enabled.
+
+A software interrupt queued by an interrupt handler has run
+when RemIntServer() of the handler returns.
+"
+func_see        "AddIntServer()"
+
+func_begin      CreateRing
+func_return     "struct Ring *"
+func_param      "unsigned int" nrec
+func_param      "size_t" recsize
+func_short      "create a single-producer single-consumer ring"
+func_long       "
+Allocate a ring channel with room for nrec records of recsize
+bytes each. nrec is rounded up to a power of two. The calling
+task becomes the consumer and a signal is allocated for it.
+
+One producer task or interrupt handler writes records in place
+with ReserveRing() and CommitRing(). The consumer reads them in
+place with ReadRing() and ReleaseRing(). No lock is taken and no
+record is copied. The producer and consumer positions are on
+separate cache lines so the two sides can run on different CPUs
+without sharing a written cache line except for the records.
+
+Use DeleteRing() to deallocate the ring and the signal.
+"
+func_result     "
+The new ring or NULL if memory or a signal could not be
+allocated.
+"
+func_see        "DeleteRing(), ReadRing(), ReserveRing()"
+
+func_begin      DeleteRing
+func_return     "void"
+func_param      "struct Ring *" ring
+func_short      "delete a ring"
+func_long       "
+Delete a ring created with CreateRing(). Shall be called by the
+consumer. The function returns immediately if ring is NULL.
+"
+func_see        "CreateRing()"
+
+func_begin      ReserveRing
+func_return     "void *"
+func_param      "struct Ring *" ring
+func_env        {isr}
+func_short      "reserve a record for writing"
+func_long       "
+Reserve the next free record of the ring. The producer writes the
+record in place and makes it visible to the consumer with
+CommitRing(). Several records can be reserved before they are
+committed together. Only the producer may call this function.
+"
+func_result     "
+Pointer to the record, or NULL if the ring is full.
+"
+func_see        "CommitRing(), WaitRingSpace()"
+
+func_begin      CommitRing
+func_return     "void"
+func_param      "struct Ring *" ring
+func_env        {isr}
+func_short      "publish reserved records"
+func_long       "
+Make all records reserved with ReserveRing() visible to the
+consumer. The consumer is signaled only if it waits in
+WaitRing(), so a batch of records costs at most one Signal().
+"
+func_see        "ReserveRing(), WaitRing()"
+
+func_begin      WaitRingSpace
+func_return     "void"
+func_param      "struct Ring *" ring
+func_short      "wait until a record can be reserved"
+func_long       "
+Wait until ReserveRing() will succeed. The producer waits with
+WaitAddress() so no signal bit of the producer is used.
+"
+func_see        "ReleaseRing(), ReserveRing()"
+
+func_begin      ReadRing
+func_return     "void *"
+func_param      "struct Ring *" ring
+func_short      "get the next record for reading"
+func_long       "
+Get the next committed record which has not been read. The
+record stays valid until it is returned to the producer with
+ReleaseRing(). Only the consumer may call this function.
+"
+func_result     "
+Pointer to the record, or NULL if there is none.
+"
+func_see        "ReleaseRing(), WaitRing()"
+
+func_begin      ReleaseRing
+func_return     "void"
+func_param      "struct Ring *" ring
+func_short      "release records which have been read"
+func_long       "
+Give all records returned by ReadRing() back to the producer. The
+producer is woken only if it waits in WaitRingSpace().
+"
+func_see        "ReadRing(), WaitRingSpace()"
+
+func_begin      WaitRing
+func_return     "void"
+func_param      "struct Ring *" ring
+func_short      "wait until a record can be read"
+func_long       "
+Wait until ReadRing() will return a record. The consumer waits on
+the ring signal, 1 << ring->sigbit, which is allocated by
+CreateRing(). The producer only signals when the consumer is in
+WaitRing(), so the consumer shall not Wait() for the ring signal
+directly.
+"
+func_see        "CommitRing(), ReadRing()"
+
+func_begin      PutMsgs
+func_return     "void"
+func_param      "struct MsgPort *" port
+func_param      "struct List *" list
+func_env        {isr}
+func_short      "send a list of messages"
+func_long       "
+Send all messages on list to a message port, in list order. The
+messages are added to the port with one lock acquisition, or one
+atomic operation for an MPF_LOCKFREE port, and the port task is
+signaled once. The list is empty when the function returns.
+"
+func_see        "GetMsgList(), PutMsg()"
+
+func_begin      GetMsgList
+func_return     "int"
+func_param      "struct MsgPort *" port
+func_param      "struct List *" list
+func_env        {isr}
+func_short      "remove all messages from a message port"
+func_long       "
+Move all messages on a message port to the tail of list, in
+arrival order. The port list is spliced in constant time.
+
+This function will never wait. For a port with MPF_LOCKFREE, only
+the port task may call this function.
+"
+func_result     "1 if any message was moved, else 0"
+func_see        "GetMsg(), PutMsgs(), WaitPort()"
+
+func_begin      GetTimeStamp
+func_return     "unsigned long"
+func_env        {isr}
+func_short      "read free running counter"
+func_long       "
+Read a free running counter for measuring short intervals. The
+counter frequency is port specific and the counter wraps around,
+so only differences between two reads are meaningful. On LEON3
+it is a GPTIMER timer, typically counting at 1 MHz. On ports
+without such a counter, ARMv6-M, the function returns 0.
+"
+func_result     "
+Counter value.
+"
+
+func_begin      InitBarrier
+func_return     "void"
+func_param      "struct Barrier *" bar
+func_param      "int" n
+func_short      "initialize a barrier"
+func_long       "
+Initialize a barrier for n tasks. The field spin can be changed
+after the initialization to tune how long WaitBarrier() polls
+before the task sleeps. It is 0 on single processor systems.
+"
+func_see        "WaitBarrier()"
+
+func_begin      WaitBarrier
+func_return     "int"
+func_param      "struct Barrier *" bar
+func_short      "wait until all tasks have arrived at a barrier"
+func_long       "
+Wait until n tasks, as given to InitBarrier(), have called
+WaitBarrier(). Then all of them return and the barrier can be
+used again for the next round.
+
+The barrier is sense-reversing: the last task to arrive flips a
+sense word which the others poll for a while and then wait on
+with WaitAddress(). When all tasks run on different CPUs and
+arrive close in time, no task sleeps and no inter-processor
+interrupt is sent. Otherwise, the last task wakes all sleepers
+with one WakeAddress().
+
+Memory accesses before WaitBarrier() in any task are visible to
+all tasks after it returns. WaitBarrier() can not be called in
+interrupt context or while holding an IntLock.
+"
+func_result     "
+1 in the last task to arrive, else 0. It can be used to select
+one task for serial work between phases.
+"
+func_see        "InitBarrier(), WaitAddress()"
+
+func_begin      WaitAddress
+func_return     "int"
+func_param      "volatile unsigned int *" addr
+func_param      "unsigned int" expected
+func_short      "wait on an address"
+func_long       "
+If the integer at addr is equal to expected, then the task waits
+until it is woken with WakeAddress() on the same address. The
+comparison and the queueing are atomic with respect to
+WakeAddress(), so a waker which stores a new value at addr and
+then calls WakeAddress() will not be missed.
+
+The waiters are kept in a hashed table of wait queues in
+exec.library, so no state is needed at addr other than the
+integer itself, and no signal bits are allocated: the task waits
+on SIGF_SINGLE. This allows building primitives which only call
+exec.library when they have to wait or when there are waiters.
+
+The caller shall check its condition again after return. The
+function can not be called in interrupt context or while holding
+an IntLock.
+"
+func_result     "
+0 if the integer at addr was not equal to expected, else 1 after
+having been woken.
+"
+func_see        "WakeAddress()"
+
+func_begin      WakeAddress
+func_return     "int"
+func_param      "volatile unsigned int *" addr
+func_param      "int" n
+func_env        {isr}
+func_short      "wake tasks waiting on an address"
+func_long       "
+Wake up to n tasks which wait on addr with WaitAddress(), in
+FIFO order. All woken tasks are made ready before the scheduler
+runs once.
+"
+func_result     "
+Number of tasks woken.
+"
+func_see        "WaitAddress()"
+
+func_begin      InitSemaphore
+func_return     "void"
+func_param      "struct Semaphore *" sem
+func_param      "int" count
+func_short      "initialize a counting semaphore"
+func_long       "
+Initialize a counting semaphore with count available units. A
+Semaphore must be initialized before first use.
+"
+func_see        "ObtainSemaphore(), ReleaseSemaphore()"
+
+func_begin      ObtainSemaphore
+func_return     "void"
+func_param      "struct Semaphore *" sem
+func_short      "obtain one unit of a counting semaphore"
+func_long       "
+Decrement the count of the semaphore. If the count is zero, then
+the task is queued and will Wait() on SIGF_SINGLE until a unit is
+handed over to it by ReleaseSemaphore(). No other signal bits are
+used. Waiting tasks are served in FIFO order.
+
+ObtainSemaphore() can not be called in interrupt context or while
+holding an IntLock.
+"
+func_see        "AttemptSemaphore(), ReleaseSemaphore()"
+
+func_begin      AttemptSemaphore
+func_return     "int"
+func_param      "struct Semaphore *" sem
+func_env        {isr}
+func_short      "obtain one unit of a counting semaphore, no wait"
+func_long       "
+Same as ObtainSemaphore() but returns immediately if no unit is
+available.
+"
+func_result     "
+1 if a unit was obtained, else 0.
+"
+func_see        "ObtainSemaphore(), ReleaseSemaphore()"
+
+func_begin      ReleaseSemaphore
+func_return     "void"
+func_param      "struct Semaphore *" sem
+func_param      "int" count
+func_env        {isr}
+func_short      "release units of a counting semaphore"
+func_long       "
+Add count units to the semaphore. The units are first handed
+over to waiting tasks, one unit to each task in FIFO order, and
+the rest are added to the semaphore count. All woken tasks are
+made ready before the scheduler runs once.
+"
+func_see        "AttemptSemaphore(), ObtainSemaphore()"
+
+func_begin      InitCondition
+func_return     "void"
+func_param      "struct Condition *" cond
+func_short      "initialize a condition variable"
+func_long       "
+A Condition must be initialized before first use.
+"
+func_see        "WaitCondition(), SignalCondition()"
+
+func_begin      WaitCondition
+func_return     "void"
+func_param      "struct Condition *" cond
+func_param      "struct Mutex *" mutex
+func_short      "wait on a condition variable"
+func_long       "
+Atomically release the Mutex and wait until the condition is
+signaled with SignalCondition() or BroadcastCondition(). The
+Mutex is obtained again before the function returns.
+
+The calling task shall own the Mutex exclusively, and not nested.
+The task waits on SIGF_SINGLE and no other signal bits are used.
+Since another task may obtain the Mutex first and change the
+state, the caller shall test its predicate again in a loop.
+"
+func_see        "BroadcastCondition(), SignalCondition()"
+
+func_begin      SignalCondition
+func_return     "void"
+func_param      "struct Condition *" cond
+func_env        {isr}
+func_short      "wake one task waiting on a condition variable"
+func_long       "
+Wake the task which has waited the longest on the condition, if
+any. The caller does not have to own the Mutex but should do so
+to avoid missed updates of the predicate.
+"
+func_see        "BroadcastCondition(), WaitCondition()"
+
+func_begin      BroadcastCondition
+func_return     "void"
+func_param      "struct Condition *" cond
+func_env        {isr}
+func_short      "wake all tasks waiting on a condition variable"
+func_long       "
+Wake all tasks waiting on the condition. All woken tasks are made
+ready before the scheduler runs once.
+"
+func_see        "SignalCondition(), WaitCondition()"
+
+func_begin      InitEventFlags
+func_return     "void"
+func_param      "struct EventFlags *" ev
+func_param      "unsigned int" flags
+func_short      "initialize an event flag group"
+func_long       "
+Initialize a group of event flags to flags. An EventFlags must be
+initialized before first use.
+"
+func_see        "SetEventFlags(), WaitEventFlags()"
+
+func_begin      WaitEventFlags
+func_return     "unsigned int"
+func_param      "struct EventFlags *" ev
+func_param      "unsigned int" mask
+func_param      "int" mode
+func_short      "wait for event flags"
+func_long       "
+Wait until any of the flags in mask are set in the group. With
+EVF_ALL in mode, wait until all the flags in mask are set. With
+EVF_CLEAR in mode, the flags in mask are cleared when the wait is
+satisfied.
+
+The task waits on SIGF_SINGLE and no other signal bits are used,
+so any number of flags and groups can be used by a task. Waiting
+tasks are satisfied in FIFO order.
+
+WaitEventFlags() can not be called in interrupt context or while
+holding an IntLock.
+"
+func_result     "
+The flags of the group when the wait was satisfied, before any
+clearing.
+"
+func_see        "ClearEventFlags(), SetEventFlags()"
+
+func_begin      SetEventFlags
+func_return     "unsigned int"
+func_param      "struct EventFlags *" ev
+func_param      "unsigned int" mask
+func_env        {isr}
+func_short      "set event flags"
+func_long       "
+Set the flags in mask and wake all tasks whose wait is satisfied.
+All woken tasks are made ready before the scheduler runs once.
+"
+func_result     "
+The flags before the operation.
+"
+func_see        "ClearEventFlags(), WaitEventFlags()"
+
+func_begin      ClearEventFlags
+func_return     "unsigned int"
+func_param      "struct EventFlags *" ev
+func_param      "unsigned int" mask
+func_env        {isr}
+func_short      "clear event flags"
+func_long       "
+Clear the flags in mask. The current flags can be read with a
+mask of 0.
+"
+func_result     "
+The flags before the operation.
+"
+func_see        "SetEventFlags(), WaitEventFlags()"
+
+func_begin      AtomicCompareSwap
+func_return     "unsigned int"
+func_param      "volatile unsigned int *" p
+func_param      "unsigned int" old
+func_param      "unsigned int" new
+func_env        {isr}
+func_short      "atomic compare-and-swap"
+func_long       "
+Atomically compare the integer at p with old and, if they are
+equal, store new at p. The operation is a full memory barrier.
+
+The functions Atomic*() operate on naturally aligned integers and
+pointers and are safe to use between tasks, interrupt handlers
+and CPUs. The header exec/atomic.h provides inline versions which
+use the instructions directly where the compiler supports it and
+call these functions otherwise.
+"
+func_result     "
+The value at p before the operation. The store was done if it is
+equal to old.
+"
+func_see        "AtomicCompareSwapPtr(), AtomicSwap()"
+
+func_begin      AtomicSwap
+func_return     "unsigned int"
+func_param      "volatile unsigned int *" p
+func_param      "unsigned int" val
+func_env        {isr}
+func_short      "atomic swap"
+func_long       "
+Atomically store val at p. The operation is a full memory
+barrier.
+"
+func_result     "
+The value at p before the operation.
+"
+func_see        "AtomicCompareSwap(), AtomicSwapPtr()"
+
+func_begin      AtomicAdd
+func_return     "unsigned int"
+func_param      "volatile unsigned int *" p
+func_param      "unsigned int" val
+func_env        {isr}
+func_short      "atomic fetch-and-add"
+func_long       "
+Atomically add val to the integer at p. The operation is a full
+memory barrier.
+"
+func_result     "
+The value at p before the operation.
+"
+func_see        "AtomicAnd(), AtomicOr()"
+
+func_begin      AtomicAnd
+func_return     "unsigned int"
+func_param      "volatile unsigned int *" p
+func_param      "unsigned int" val
+func_env        {isr}
+func_short      "atomic fetch-and-and"
+func_long       "
+Atomically do a bitwise and of val into the integer at p. The
+operation is a full memory barrier.
+"
+func_result     "
+The value at p before the operation.
+"
+func_see        "AtomicAdd(), AtomicOr()"
+
+func_begin      AtomicOr
+func_return     "unsigned int"
+func_param      "volatile unsigned int *" p
+func_param      "unsigned int" val
+func_env        {isr}
+func_short      "atomic fetch-and-or"
+func_long       "
+Atomically do a bitwise or of val into the integer at p. The
+operation is a full memory barrier.
+"
+func_result     "
+The value at p before the operation.
+"
+func_see        "AtomicAdd(), AtomicAnd()"
+
+func_begin      AtomicCompareSwapPtr
+func_return     "void *"
+func_param      "void *volatile *" p
+func_param      "void *" old
+func_param      "void *" new
+func_env        {isr}
+func_short      "atomic compare-and-swap of a pointer"
+func_long       "
+Same as AtomicCompareSwap() but operates on a pointer.
+"
+func_result     "
+The pointer at p before the operation.
+"
+func_see        "AtomicCompareSwap(), AtomicSwapPtr()"
+
+func_begin      AtomicSwapPtr
+func_return     "void *"
+func_param      "void *volatile *" p
+func_param      "void *" val
+func_env        {isr}
+func_short      "atomic swap of a pointer"
+func_long       "
+Same as AtomicSwap() but operates on a pointer.
+"
+func_result     "
+The pointer at p before the operation.
+"
+func_see        "AtomicCompareSwapPtr(), AtomicSwap()"
+
+func_begin      AtomicAcquire
+func_return     "void"
+func_env        {isr}
+func_short      "acquire memory barrier"
+func_long       "
+Loads before the barrier are ordered before all loads and stores
+after it. Typically used after reading a flag which says that
+data is ready.
+"
+func_see        "AtomicFence(), AtomicRelease()"
+
+func_begin      AtomicRelease
+func_return     "void"
+func_env        {isr}
+func_short      "release memory barrier"
+func_long       "
+Loads and stores before the barrier are ordered before all stores
+after it. Typically used before writing a flag which says that
+data is ready.
+"
+func_see        "AtomicAcquire(), AtomicFence()"
+
+func_begin      AtomicFence
+func_return     "void"
+func_env        {isr}
+func_short      "full memory barrier"
+func_long       "
+All loads and stores before the barrier are ordered before all
+loads and stores after it.
+"
+func_see        "AtomicAcquire(), AtomicRelease()"
+
+func_begin      ObtainRCU
+func_return     "void"
+func_env        {isr}
+func_short      "enter an RCU read-side section"
+func_long       "
+Begin reading a list which is updated with read-copy-update
+(RCU). Nodes which are reachable when the section begins are not
+deallocated or reused before the section ends with ReleaseRCU().
+The reader does not take any lock and does not use atomic
+operations, so readers never wait for writers or for each other.
+
+Writers serialize among themselves with a lock of their choice,
+publish new nodes completely initialized, and use SyncRCU() or
+CallRCU() before a removed node is deallocated or reused.
+
+Sections may nest. Task switches are disabled on the local CPU
+while in a section, so the calling context must not Wait(). On
+single processor systems, interrupts are disabled while in a
+section.
+
+ObtainRCU() may be called from task or interrupt context.
+"
+func_see        "CallRCU(), ReleaseRCU(), SyncRCU()"
+
+func_begin      ReleaseRCU
+func_return     "void"
+func_env        {isr}
+func_short      "leave an RCU read-side section"
+func_long       "
+End a read-side section started with ObtainRCU(). Nodes found
+during the section must not be accessed after this call, unless
+they are protected by other means, for example an open count
+updated during the section.
+"
+func_see        "ObtainRCU()"
+
+func_begin      SyncRCU
+func_return     "void"
+func_short      "wait for an RCU grace period"
+func_long       "
+Wait until all read-side sections which were active when this
+function was called have ended. Each CPU passes a quiescent state
+when it switches tasks, and CPUs which have not done so are sent
+an inter-processor interrupt to hurry them up.
+
+A writer calls this function after removing a node from a list
+and before deallocating or reusing it. This function must not be
+called in a read-side section or in interrupt context.
+"
+func_see        "CallRCU(), ObtainRCU()"
+
+func_begin      CallRCU
+func_return     "void"
+func_param      "struct RCUHead *" head
+func_param      "void (*func)(struct ExecBase *lib, struct RCUHead *head)" func isfunc
+func_env        {isr}
+func_short      "defer an operation until after a grace period"
+func_long       "
+Arrange for func(lib, head) to be called after all read-side
+sections active at the time of the call have ended. The head is
+typically embedded in a removed node and func deallocates the
+node. This function returns immediately and can be used where
+SyncRCU() can not, for example in interrupt context.
+
+The function is called by a system task. It should be short and
+must not call SyncRCU().
+"
+func_see        "ObtainRCU(), SyncRCU()"
+
+func_begin      CreateBRLock
+func_return     "struct BRLock *"
+func_short      "create a big-reader IntLock"
+func_long       "
+Allocate and initialize a BRLock. A BRLock is a reader-writer
+IntLock with reader state for each CPU. Readers obtain the lock
+with ObtainBRLockShared() and only access memory local to their
+CPU, so readers on different CPUs do not serialize on a shared
+cache line. Writers obtain the lock with ObtainBRLock(), which
+has to inspect the reader state of all CPUs.
+
+A BRLock is intended for invariants which are read frequently,
+for example in interrupt context, and are modified rarely.
+
+Use DeleteBRLock() to deallocate the lock.
+"
+func_result     "
+The new lock is returned. If memory could not be allocated, then
+NULL is returned.
+"
+func_see        "DeleteBRLock(), ObtainBRLock(), ObtainBRLockShared()"
+
+func_begin      DeleteBRLock
+func_return     "void"
+func_param      "struct BRLock *" lock
+func_short      "delete a big-reader IntLock"
+func_long       "
+Delete a BRLock created with CreateBRLock(). The lock must not be
+held.
+
+The function returns immediately if lock is NULL.
+"
+func_see        "CreateBRLock()"
+
+func_begin      ObtainBRLockShared
+func_return     "void"
+func_param      "struct BRLock *" lock
+func_env        {isr}
+func_short      "obtain a BRLock for reading"
+func_long       "
+Gain shared access to an invariant protected by a BRLock. Any
+number of contexts, on any CPU, can hold the lock in shared mode
+at the same time, but not while it is held by a writer. A lock
+obtained in shared mode must be released with ReleaseBRLock() by
+the same context.
+
+On SMP systems, interrupt processing is not disabled while the
+lock is held in shared mode, and the same lock may be obtained in
+shared mode again by nested interrupt handlers. Task switches
+are disabled on the local CPU until the lock is released, so the
+calling context must not Wait() or do anything else which
+requires a task switch while holding the lock.
+
+If a writer holds or waits for the lock, then the first reader
+on a CPU enables task switches and spins with interrupts enabled
+until the writer has released it. A task may then continue on
+another CPU.
+
+ObtainBRLockShared() may be called from task or interrupt
+context.
+"
+func_see        "CreateBRLock(), ObtainBRLock(), ReleaseBRLock()"
+
+func_begin      ObtainBRLock
+func_return     "void"
+func_param      "struct BRLock *" lock
+func_env        {isr}
+func_short      "obtain a BRLock for writing"
+func_long       "
+Gain exclusive access to an invariant protected by a BRLock.
+When this function returns, no other context holds the lock in
+shared or exclusive mode. The lock must be released with
+ReleaseBRLock() by the same CPU.
+
+While another writer holds the lock, the caller spins with
+interrupts enabled. Local interrupt processing is then disabled
+while it waits for the readers and while the lock is held, as for
+ObtainIntLock(). The calling context must not hold the same lock
+in shared mode, and must not have interrupted a context on the
+local CPU which holds it in shared mode. The cost of this
+function grows with the number of CPUs.
+"
+func_see        "CreateBRLock(), ObtainBRLockShared(), ReleaseBRLock()"
+
+func_begin      ReleaseBRLock
+func_return     "void"
+func_param      "struct BRLock *" lock
+func_env        {isr}
+func_short      "release a BRLock"
+func_long       "
+This function releases a BRLock which was obtained with
+ObtainBRLock() or ObtainBRLockShared(). If a task switch was
+requested on the local CPU while the final shared lock was held,
+then it is done here.
+"
+func_see        "ObtainBRLock(), ObtainBRLockShared()"
+
+func_begin      ObtainMutexShared
+func_return     "void"
+func_param      "struct Mutex *" mutex
+func_short      "obtain a Mutex in shared mode"
+func_long       "
+Gain shared access to an invariant protected by a Mutex. Any
+number of tasks can hold the same Mutex in shared mode at the
+same time, but not while another task holds it exclusively with
+ObtainMutex(). Shared access is intended for readers of the
+protected state. A Mutex obtained in shared mode must be
+released with ReleaseMutex().
+
+If the Mutex is held exclusively by another task, or if there are
+tasks waiting for the Mutex, then the calling task will Wait() on
+SIGF_SINGLE until it is granted access. Waiting tasks are served
+in FIFO order, and all consecutive shared waiters at the head of
+the queue are granted access at the same time.
+
+If the calling task already holds the Mutex exclusively, then the
+call nests as if ObtainMutex() was called. A task should not
+obtain the same Mutex in shared mode multiple times: it will
+deadlock if another task is waiting for exclusive access in
+between.
+
+The same restrictions as for ObtainMutex() apply.
+"
+func_see        "InitMutex(), ObtainMutex(), ReleaseMutex()"
+
 func_begin      CreateTask
 func_return     "struct Task *"
 func_param      "char *" name
@@ -79,6 +1218,13 @@ port.
 A task signals is a task property, so the created message port
 can only be used by the task calling this function.
 
+The owner can set MPF_LOCKFREE in the port flags before the port
+is made known to others. Messages are then queued without taking
+a lock, so many senders on different CPUs do not serialize with
+each other or with the receiver. Only the port task may call
+GetMsg(), WaitPort() and WaitMsg() on such a port, and never from
+interrupt context.
+
 Use DeleteMsgPort() to deallocate the port and signal.
 "
 func_result     "
@@ -337,7 +1483,7 @@ Interrupt.data as argument.
 
 Note that the definition of intnum is port specific.
 "
-func_see        "RemIntServer()"
+func_see        "AddIntThread(), Cause(), RemIntServer()"
 
 func_begin      RemIntServer
 func_return     "void"
@@ -348,6 +1494,9 @@ func_long       "
 Remove interrupt from the chain of interrupt handlers for
 interrupt intnum. Interrupt intnum will be disabled (masked)
 when the last handler is unregistered.
+
+When this function returns, the handler is not executing on any
+CPU and the Interrupt structure may be reused or deallocated.
 "
 func_see        "AddIntServer()"
 
@@ -389,6 +1538,13 @@ func_long       "
 Send a message to a message port. This performs asynchronous
 message passing. It will signal the port task with the port
 signal number.
+
+The signal is only sent when the port goes from empty to
+non-empty, or when the port task is in WaitMsg(). So a receiver
+shall remove all messages, GetMsg() until it returns NULL, before
+it waits for the port signal again. WaitPort() and WaitMsg() do
+that. The number of messages sent without a signal is counted in
+the port field suppressed.
 "
 func_see        "GetMsg(), ReplyMsg(), WaitMsg(), WaitPort()"
 
@@ -402,6 +1558,9 @@ Remove and message from a message port.
 
 This function will never wait. It will RemHead() a Message from
 the message port.
+
+For a port with MPF_LOCKFREE, only the port task may call this
+function.
 "
 func_result     "the removed message or NULL if none"
 func_see        "PutMsg(), ReplyMsg(), WaitMsg(), WaitPort()"
@@ -762,6 +1921,10 @@ allocated memory should be deallocated with FreeMem().
 Numbytes it the number of bytes to allocate. This may be 0, in
 which case the function behaves as if numbytes were 1.
 
+If no memory header can satisfy the request, the Task and stack
+pairs which CreateTask() keeps for reuse are freed and the
+allocation is tried once more.
+
 Attributes are a mask of:
   * requirements:
     * MEMF_DMA:   memory which you can do DMA with
@@ -879,7 +2042,8 @@ func_long       "
 Gain exclusive access to an invariant protected by a Mutex.
 When this function returns, the calling context has exclusive
 access to the state protected by the mutex.  An obtained Mutex
-must be released with a call to ReleaseMutex().
+must be released with a call to ReleaseMutex(). Shared access
+can be requested with ObtainMutexShared().
 
 If Mutex is available, then this function will return
 immediately; if the Mutex can not be obtained immediately, then
@@ -898,7 +2062,7 @@ This function will not disable interrupt processing or task
 switches. A Mutex can not be obtained in interrupt context or
 while holding an IntLock.
 "
-func_see        "InitIntLock(), ObtainMutex(), ReleaseIntLock()"
+func_see        "InitMutex(), ObtainMutexShared(), ReleaseMutex()"
 
 func_begin      ReleaseMutex
 func_return     "void"
@@ -906,11 +2070,13 @@ func_param      "struct Mutex *" mutex
 func_short      "release a Mutex"
 func_long       "
 This funcion releases a Mutex which was obtained with
-ObtainMutex(). If this was the final release and if there are
-other tasks waiting for the mutex, then the first task will be
+ObtainMutex() or ObtainMutexShared(). If this was the final
+release and if there are other tasks waiting for the mutex, then
+the first task will be unblocked. If the first waiting task
+requested shared access, then all consecutive shared waiters are
 unblocked.
 "
-func_see        "InitMutex(), ObtainMutex(), ReleaseIntLock()"
+func_see        "InitMutex(), ObtainMutex(), ObtainMutexShared()"
 
 func_begin      InitIntLock
 func_return     "void"
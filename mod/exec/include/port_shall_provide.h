@@ -4,6 +4,10 @@
 int port_disable_interrupts(void);
 void port_enable_interrupts(int level);
 void port_halt(void);
+/* Full memory barrier: orders all earlier loads and stores. */
+void port_memory_barrier(void);
+/* Free running counter for measurements, 0 if not available. */
+unsigned long port_get_timestamp(void);
 
 /*
  * Number of interrupt sources (intnum) port understands,
@@ -14,18 +18,39 @@ int port_get_numinterrupts(void);
 void port_enable_intnum(int intnum);
 void port_disable_intnum(int intnum);
 
+/*
+ * Single processor: make runsoftints() run when no interrupt
+ * handler is active, before returning to the task.
+ */
+void port_raise_softint(void);
+
 Task *port_ThisTask(Lib *lib);
 /* Do port specific task initializations */
 void port_prepstack(Lib *lib, Task *task);
 
+/*
+ * Coroutine switch: save the callee-saved registers on the current
+ * stack, store the stack pointer in *save and continue with the
+ * context at sp. The callee-saved FPU registers are included only
+ * if fpu is non-zero, and restored only if they were saved.
+ */
+void port_coswitch(void **save, void *sp, int fpu);
+/* Return non-zero once task has used the FPU. */
+int port_usedfpu(const Task *task);
+/* Context below top which port_coswitch() continues in coentry(). */
+void *port_coprep(void *top);
+
 
 /* Functions needed for SMP operation (mostly mp.c) */
 
 /* called by the primary processor to start others available */
 void port_start_other_processors(Lib *lib);
 ExecCPU *port_get_cpu(void);
-void port_set_cpu(ExecCPU *cpu);
-/* Upper limit on CPU:s to use. */
+/* also loads thistask into the port_get_thistask() register */
+void port_set_cpu(ExecCPU *cpu, Task *thistask);
+/* Task last switched to by port_switch_tasks() on this CPU */
+Task *port_get_thistask(void);
+/* Upper limit on CPU:s to use. Single processor ports return 1. */
 int port_get_ncpu(Lib *lib);
 /* ExecCPU structure is port specific, so let it allocate it. */
 ExecCPU *port_alloc_cpu(Lib *lib);
@@ -1,6 +1,21 @@
 /* SPDX-License-Identifier: GPL-2.0 */
 /* Copyright 2019-2022 Martin Åberg */
 
+/*
+ * CFG_TASKSTATS and CFG_LATENCY select private fields of struct
+ * Task, so they are defined before <exec/exec.h>.
+ */
+
+/* 0: no accounting in switch_tasks(), 1: GetTaskStats() */
+#ifndef CFG_TASKSTATS
+# define CFG_TASKSTATS 0
+#endif
+
+/* 0: no latency tracing, 1: GetLatency() histograms */
+#ifndef CFG_LATENCY
+# define CFG_LATENCY 0
+#endif
+
 #include <exec/exec.h>
 #include <exec/libcall.h>
 #include <exec/op.h>
@@ -20,12 +35,30 @@
   }
 #endif
 
+/* 0: fast AddTask(), 1: paint task stacks for GetStackUsage() */
+#ifndef CFG_STACKPAINT
+# define CFG_STACKPAINT 0
+#endif
+
+/*
+ * Stack size in bytes of the work queue tasks, see QueueWork().
+ * Below ExecBase.minstack, such as 0, gives minstack.
+ */
+#ifndef CFG_WORKSTACK
+# define CFG_WORKSTACK 4096
+#endif
+
 #define Alert_Exception   (AT_DeadEnd|AN_ExecLib|AG_Exception)
 #define Alert_StackCheck  (AT_DeadEnd|AN_ExecLib|AG_StackCheck)
 #define Alert_Canaries    (AT_DeadEnd|AN_ExecLib|AG_Canaries)
 
 #define NELEM(v) ((sizeof (v)) / (sizeof (v[0])))
 
+typedef struct Barrier          Barrier;
+typedef struct BRLock           BRLock;
+typedef struct Condition        Condition;
+typedef struct Coroutine        Coroutine;
+typedef struct BRLockSlot       BRLockSlot;
 typedef struct Device           Device;
 typedef struct DeviceOp         DeviceOp;
 typedef struct ExecBase         Lib;
@@ -33,8 +66,11 @@ typedef struct ExecBaseOp       LibOp;
 typedef struct IORequest        IORequest;
 typedef struct IntLock          IntLock;
 typedef struct Interrupt        Interrupt;
+typedef struct IntThread        IntThread;
 typedef struct Library          Library;
 typedef struct LibraryOp        LibraryOp;
+typedef struct LatencyStats     LatencyStats;
+typedef struct LightTask        LightTask;
 typedef struct List             List;
 typedef struct MemChunk         MemChunk;
 typedef struct MemEntry         MemEntry;
@@ -46,26 +82,63 @@ typedef struct MsgPort          MsgPort;
 typedef struct Mutex            Mutex;
 typedef struct Node             Node;
 typedef struct ExecCPU          ExecCPU;
+typedef struct EventFlags       EventFlags;
 typedef struct Resident         Resident;
 typedef struct ResidentInfo     ResidentInfo;
 typedef struct ResidentAuto     ResidentAuto;
 typedef struct ResidentNode     ResidentNode;
+typedef struct Ring             Ring;
 typedef struct Segment          Segment;
+typedef struct Semaphore        Semaphore;
 typedef struct StackCanaries    StackCanaries;
 typedef struct Task             Task;
 typedef struct TaskArch         TaskArch;
+typedef struct TaskStats        TaskStats;
+typedef struct WaitQueue        WaitQueue;
+typedef struct Work             Work;
+typedef struct WorkQueue        WorkQueue;
 
+/* Move all nodes of src to the tail of dst, in O(1) */
+void movelist(Lib *lib, List *dst, List *src);
 /* Enqueue(list, node) under Mutex lock */
 void enqnode(Lib *lib, Node *node, List *list, Mutex *lock);
 /* Call l->Expunge() and maybe free memory */
 Segment *expungelib(Lib *lib, Library *l);
 /* for RemLibrary() and RemDevice() */
 void remlib(Lib *lib, Library *l, Mutex *lock);
+/* l->opencount++ under ObtainRCU(). Return 0 if being removed */
+int incopen(Lib *lib, Library *l);
+/* l->opencount-- and maybe remove. Return 1 if removed */
+int decopen(Lib *lib, Library *l, Mutex *lock);
+/* Complete an open. Return 1 if caller shall call expungelib() */
+int endopen(Lib *lib, Library *l, Mutex *lock, int ok);
 
 /* Installed when tasking is possible */
 void iObtainMut(Lib *lib, Mutex *ctx);
+void iObtainMutShared(Lib *lib, Mutex *ctx);
 void iReleaseMut(Lib *lib, Mutex *ctx);
 
+/*
+ * A task waiting on a Mutex, Semaphore, Condition, EventFlags or
+ * in WaitAddress().
+ * The Waiter lives on the stack of the waiting task, which waits
+ * for SIGF_SINGLE.
+ */
+typedef struct {
+  Node node;
+  Task *task;
+  int shared;          /* Mutex: shared access */
+  unsigned int mask;   /* EventFlags: flags waited for */
+  int mode;            /* EventFlags: EVF_ALL, EVF_CLEAR */
+  unsigned int result; /* EventFlags: flags when satisfied */
+  volatile unsigned int *addr; /* WaitAddress() */
+} Waiter;
+
+/* Signal() without reschedule. Return 1 if lReschedule() needed */
+int wakeup(Lib *lib, Task *task, unsigned int sigmask);
+/* Signal SIGF_SINGLE to the Waiters on wake and reschedule once */
+void wakeall(Lib *lib, List *wake);
+
 /* spin lock implementation */
 void iObtainIntLockDisabled(Lib *lib, IntLock *const lock);
 void iReleaseIntLockDisabled(Lib *lib, IntLock *const lock);
@@ -94,11 +167,43 @@ void start_on_primary(Lib *lib, unsigned long id);
 void start_on_secondary(Lib *lib, unsigned long id);
 void runintservers(Lib *lib, int intnum);
 void intserver_init(Lib *lib, int num);
+/* port_disable_intnum() from an interrupt server */
+void maskintnum(Lib *lib, int intnum);
+/* port_enable_intnum() if intnum still has servers */
+void unmaskintnum(Lib *lib, int intnum);
+/* run software interrupts queued by Cause() */
+void runsoftints(Lib *lib);
 ExecCPU *switch_tasks(Lib *lib, ExecCPU *cpu);
 ExecCPU *switch_tasks_if_needed(Lib *lib, ExecCPU *cpu);
+/* switch_disable-- and do a pending switch, interrupts disabled */
+void switch_enable(Lib *lib, ExecCPU *cpu, int level);
+/* TaskStats when task leaves or enters the local CPU */
+void stat_switchout(Lib *lib, Task *task);
+void stat_switchin(Lib *lib, Task *task);
+/* LatencyStats hooks, see latency.c */
+void lat_wakeup(Lib *lib, Task *task, const Task *prev,
+ unsigned int cpu);
+void lat_ipisend(Lib *lib, const ExecCPU *cpu);
+void lat_ipirecv(Lib *lib, const ExecCPU *cpu);
+/* allocate the LatencyStats, before the other CPUs start */
+void startlatency(Lib *lib);
+/* Enqueue() for lists read under ObtainRCU() */
+void enqueue_rcu(Lib *lib, List *list, Node *node);
+/* called by the cleanup work to run CallRCU() operations */
+void runrcu(Lib *lib);
+/* called by the cleanup work, return 1 if ml was kept for reuse */
+int cachetask(Lib *lib, MemList *ml);
+/* give the cached tasks back to the allocator, 1 if there were any */
+int flushtaskcache(Lib *lib);
+/* create the WorkQueues and their worker tasks */
+void startwork(Lib *lib);
+/* WorkQueue of the calling CPU */
+WorkQueue *localwork(Lib *lib);
 /* shall be called by local CPU when receiving IPI */
-void announce_ipi(void);
+void announce_ipi(Lib *lib);
 void task_entry(Lib *lib);
+/* first function of a Coroutine, see port_coprep() */
+void coentry(Lib *lib);
 ExecCPU *findcpu(Lib *lib, unsigned int id);
 void check_canaries(Lib *lib, StackCanaries *can);
 
@@ -11,7 +11,7 @@
  * - Any task shall be able to call {Add,Rem}IntServer() at any
  *   time
  * - Interrupts must be able to nest
- * - All servers shall be called with the list lock held
+ * - All servers shall be called in an RCU read-side section
  * - Same or different interrupt on different CPU simultaneously
  *   - could limit that requirement, for example all ISR on
  *     CPUn.
@@ -19,84 +19,50 @@
  */
 
 /*
- * rwlock based on IntLock with opportunity to optimize
- *
- * Note that the implementation is not general. It assumes that
- * the reader executes in a context which can never Wait(). It
- * is OK for the reader to be interrupted (nesting).
+ * The lists are read on every interrupt, possibly on all CPUs at
+ * the same time, and are modified rarely. Readers traverse a list
+ * under ObtainRCU() so interrupts on different CPUs run their
+ * servers concurrently without touching shared cache lines.
+ * Writers serialize on the list IntLock and RemIntServer() waits
+ * for a grace period so that the caller can reuse the node.
  */
-typedef struct {
-  IntLock r;
-  IntLock g;
-  int b;
-} RWLock;
-
-static void rwlock_init(Lib *lib, RWLock *rwlock) {
-  lInitIntLock(lib, &rwlock->r);
-  lInitIntLock(lib, &rwlock->g);
-  rwlock->b = 0;
-}
-
-/*
- * In rlock/runlock, the Obtain(g) and Release(g) can be on
- * different CPUs. That means that the
- * port_{enable/disable}_interrupts() could get out of sync if
- * standard Obtain() and Release() was used. In addition, that
- * would mean running the intservers in port_disable state so no
- * nesting is possible.
- *
- * The solution is to use dedicated ObtainDisabled() and
- * ReleaseDisabled().
- */
-static void rwlock_rlock(Lib *lib, RWLock *rwlock) {
-  lObtainIntLock(lib, &rwlock->r);
-  if (rwlock->b == 0) {
-    /* The first reader entering will lock out writers */
-    iObtainIntLockDisabled(lib, &rwlock->g);
-  }
-  rwlock->b++;
-  lReleaseIntLock(lib, &rwlock->r);
-}
-
-static void rwlock_runlock(Lib *lib, RWLock *rwlock) {
-  lObtainIntLock(lib, &rwlock->r);
-  rwlock->b--;
-  if (rwlock->b == 0) {
-    /* The final reader leaving will re-allow writers */
-    iReleaseIntLockDisabled(lib, &rwlock->g);
-  }
-  lReleaseIntLock(lib, &rwlock->r);
-}
-
-static void rwlock_wlock(Lib *lib, RWLock *rwlock) {
-  lObtainIntLock(lib, &rwlock->g);
-}
-
-static void rwlock_wunlock(Lib *lib, RWLock *rwlock) {
-  lReleaseIntLock(lib, &rwlock->g);
-}
 
 /* Contains all handlers for an interrupt source (intnum) */
 typedef struct IntList {
   List list;
-  RWLock rwlock;
+  IntLock lock;
 } IntList;
 
 static void intlist_init(Lib *lib, IntList *islist) {
   iNewList(lib, &islist->list);
-  rwlock_init(lib, &islist->rwlock);
+  lInitIntLock(lib, &islist->lock);
 }
 static void intlist_wlock(Lib *lib, IntList *islist) {
-  rwlock_wlock(lib, &islist->rwlock);
+  lObtainIntLock(lib, &islist->lock);
 }
 static void intlist_wunlock(Lib *lib, IntList *islist) {
-  rwlock_wunlock(lib, &islist->rwlock);
+  lReleaseIntLock(lib, &islist->lock);
 }
 static void intlist_rlock(Lib *lib, IntList *islist) {
-  rwlock_rlock(lib, &islist->rwlock);
+  lObtainRCU(lib);
 }
 static void intlist_runlock(Lib *lib, IntList *islist) {
-  rwlock_runlock(lib, &islist->rwlock);
+  lReleaseRCU(lib);
+}
+
+/*
+ * The interrupt controller mask is read-modify-write and can be
+ * changed for different intnum on different CPUs at the same time,
+ * so it is serialized by ExecBase.intmasklock.
+ */
+static void setmask(Lib *lib, int intnum, int enable) {
+  lObtainIntLock(lib, &lib->intmasklock);
+  if (enable) {
+    port_enable_intnum(intnum);
+  } else {
+    port_disable_intnum(intnum);
+  }
+  lReleaseIntLock(lib, &lib->intmasklock);
 }
 
 void iAddIntServer(Lib *lib, Interrupt *inode, int intnum) {
@@ -105,8 +71,8 @@ void iAddIntServer(Lib *lib, Interrupt *inode, int intnum) {
   inode->node.type = NT_INTERRUPT;
   islist = &lib->intserver[intnum];
   intlist_wlock(lib, islist);
-  iEnqueue(lib, &islist->list, &inode->node);
-  port_enable_intnum(intnum);
+  enqueue_rcu(lib, &islist->list, &inode->node);
+  setmask(lib, intnum, 1);
   intlist_wunlock(lib, islist);
 }
 
@@ -117,9 +83,11 @@ void iRemIntServer(Lib *lib, Interrupt *inode, int intnum) {
   intlist_wlock(lib, islist);
   iRemove(lib, &inode->node);
   if (iGetHead(lib, &islist->list) == NULL) {
-    port_disable_intnum(intnum);
+    setmask(lib, intnum, 0);
   }
   intlist_wunlock(lib, islist);
+  /* Interrupts on other CPUs may still run the server. */
+  lSyncRCU(lib);
 }
 
 /* called from interrupt exception handler */
@@ -138,10 +106,26 @@ void runintservers(Lib *lib, int intnum) {
   intlist_runlock(lib, islist);
 }
 
+void maskintnum(Lib *lib, int intnum) {
+  setmask(lib, intnum, 0);
+}
+
+void unmaskintnum(Lib *lib, int intnum) {
+  IntList *islist;
+
+  islist = &lib->intserver[intnum];
+  intlist_wlock(lib, islist);
+  if (iGetHead(lib, &islist->list)) {
+    setmask(lib, intnum, 1);
+  }
+  intlist_wunlock(lib, islist);
+}
+
 /* called once at init */
 void intserver_init(Lib *lib, int num) {
   IntList *islist;
 
+  lInitIntLock(lib, &lib->intmasklock);
   islist = iAllocMem(lib, num * sizeof *islist, MEMF_ANY);
   KASSERT(islist);
   for (int i = 0; i < num; i++) {
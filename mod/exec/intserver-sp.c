@@ -52,6 +52,26 @@ void runintservers(Lib *lib, int intnum) {
   }
 }
 
+void maskintnum(Lib *lib, int intnum) {
+  int level;
+
+  level = port_disable_interrupts();
+  port_disable_intnum(intnum);
+  port_enable_interrupts(level);
+}
+
+void unmaskintnum(Lib *lib, int intnum) {
+  IntList *islist;
+  int level;
+
+  islist = &lib->intserver[intnum];
+  level = port_disable_interrupts();
+  if (iGetHead(lib, &islist->list)) {
+    port_enable_intnum(intnum);
+  }
+  port_enable_interrupts(level);
+}
+
 /* called once at init */
 void intserver_init(Lib *lib, int num) {
   IntList *islist;
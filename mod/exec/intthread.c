@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Interrupt servers which run in a task */
+
+#include <priv.h>
+#include <port.h>
+#include <exec/atomic.h>
+
+/*
+ * A short server masks the interrupt source and signals the
+ * thread. The thread calls the handler and unmasks the source
+ * again, unless the last server of intnum has been removed in the
+ * meantime.
+ */
+
+static void intstub(Lib *lib, void *data) {
+  IntThread *it = data;
+
+  maskintnum(lib, it->intnum);
+  it->pending = 1;
+  lSignal(lib, it->task, 1U << it->sigbit);
+}
+
+static void intthread(Lib *lib) {
+  IntThread *it;
+  unsigned int sigmask;
+
+  it = lFindTask(lib)->user;
+  it->sigbit = lAllocSignal(lib, -1);
+  KASSERT(0 <= it->sigbit);
+  sigmask = 1U << it->sigbit;
+  lSignal(lib, it->owner, SIGF_SINGLE);
+  while (1) {
+    lWait(lib, sigmask);
+    if (atomic_swap(lib, &it->pending, 0)) {
+      it->interrupt.code(lib, it->interrupt.data);
+      unmaskintnum(lib, it->intnum);
+    }
+    if (it->quit) {
+      break;
+    }
+  }
+  lSignal(lib, it->owner, SIGF_SINGLE);
+}
+
+Task *iAddIntThread(
+  Lib *lib,
+  IntThread *it,
+  int intnum,
+  int priority,
+  size_t stacksize
+) {
+  it->interrupt.node.type = NT_INTERRUPT;
+  it->server.node.name = it->interrupt.node.name;
+  it->server.node.pri = it->interrupt.node.pri;
+  it->server.data = it;
+  it->server.code = intstub;
+  it->owner = lFindTask(lib);
+  it->intnum = intnum;
+  it->pending = 0;
+  it->quit = 0;
+
+  lClearSignal(lib, SIGF_SINGLE);
+  it->task = lCreateTask(lib, it->interrupt.node.name, priority,
+   intthread, it, NULL, stacksize);
+  if (it->task == NULL) {
+    return NULL;
+  }
+  /* Wait for the signal bit to be allocated. */
+  lWait(lib, SIGF_SINGLE);
+  lAddIntServer(lib, &it->server, intnum);
+  return it->task;
+}
+
+void iRemIntThread(Lib *lib, IntThread *it) {
+  /* The stub is not running on any CPU when this returns. */
+  lRemIntServer(lib, &it->server, it->intnum);
+  it->owner = lFindTask(lib);
+  it->quit = 1;
+  lClearSignal(lib, SIGF_SINGLE);
+  lSignal(lib, it->task, 1U << it->sigbit);
+  lWait(lib, SIGF_SINGLE);
+}
+
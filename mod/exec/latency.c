@@ -0,0 +1,296 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Wakeup and IPI latency histograms */
+
+#include <priv.h>
+#include <port.h>
+#include <exec/atomic.h>
+
+/*
+ * wakeup() stamps a task when it becomes ready and switch_tasks()
+ * records the time until it runs, per priority of the woken task.
+ * setheir() stamps the target CPU before port_send_ipi() and
+ * announce_ipi() records the time until the IPI arrives. Both
+ * spans may cross CPUs, so they are only meaningful on ports where
+ * GetTimeStamp() reads a counter shared by all CPUs. ARMv6-M has
+ * no counter and can not be built with CFG_LATENCY 1.
+ *
+ * The first NLATPRI priorities seen get a histogram each, later
+ * ones are not recorded.
+ */
+
+enum {
+  NLATPRI  = 8,
+  LATIPI   = NLATPRI,
+  NLAT     = NLATPRI + 1,
+};
+
+/*
+ * ExecBase.latipi[cpu id], written by the sender under tasklock and
+ * cleared by the target
+ */
+struct LatencyIPI {
+  unsigned long    stamp;
+  Task            *sender;
+  volatile int     pending;
+};
+
+static void copystr(char *dst, const char *s) {
+  int i;
+
+  for (i = 0; i < LAT_NAMELEN - 1 && s[i]; i++) {
+    dst[i] = s[i];
+  }
+  dst[i] = '\0';
+}
+
+static void copyname(char *dst, const Task *task) {
+  copystr(dst, task && task->node.name ? task->node.name : "-");
+}
+
+static int bucketof(unsigned long t) {
+  int i;
+
+  i = 0;
+  while (1 < t && i < LAT_NBUCKET - 1) {
+    t >>= 1;
+    i++;
+  }
+  return i;
+}
+
+static void record(LatencyStats *ls, unsigned long t, unsigned int cpu,
+ const Task *task, const Task *waker, const Task *prev) {
+  ls->n++;
+  ls->bucket[bucketof(t)]++;
+  if (ls->n == 1 || ls->max < t) {
+    ls->max = t;
+    ls->maxcpu = cpu;
+    copyname(ls->maxtask, task);
+    copyname(ls->maxwaker, waker);
+    copyname(ls->maxprev, prev);
+  }
+}
+
+/* Slots are taken in order, so the first free one ends the search. */
+static LatencyStats *slotof(LatencyStats *lat, int pri) {
+  for (int i = 0; i < NLATPRI; i++) {
+    if (lat[i].n == 0) {
+      lat[i].pri = pri;
+      return &lat[i];
+    }
+    if (lat[i].pri == pri) {
+      return &lat[i];
+    }
+  }
+  return NULL;
+}
+
+#if CFG_LATENCY
+/* Called with interrupts disabled when task is switched in. */
+void lat_wakeup(Lib *lib, Task *task, const Task *prev,
+ unsigned int cpu) {
+  unsigned long t;
+  LatencyStats *ls;
+
+  if (lib->latency == NULL) {
+    task->waker = NULL;
+    return;
+  }
+  t = port_get_timestamp() - task->wakestamp;
+  iObtainIntLockDisabled(lib, &lib->latencylock);
+  ls = slotof(lib->latency, task->node.pri);
+  if (ls) {
+    record(ls, t, cpu, task, task->waker, prev);
+  }
+  iReleaseIntLockDisabled(lib, &lib->latencylock);
+  task->waker = NULL;
+}
+#endif
+
+/* NULL until startlatency() has run */
+static struct LatencyIPI *ipiof(Lib *lib, const ExecCPU *cpu) {
+  struct LatencyIPI *ipi;
+
+  ipi = lib->latipi;
+  if (ipi == NULL) {
+    return NULL;
+  }
+  atomic_acquire(lib);
+  KASSERT(cpu->id < (unsigned long) lib->nlatipi);
+  return &ipi[cpu->id];
+}
+
+/* Called under tasklock before the IPI to cpu is sent. */
+void lat_ipisend(Lib *lib, const ExecCPU *cpu) {
+  struct LatencyIPI *ipi;
+
+  ipi = ipiof(lib, cpu);
+  if (ipi == NULL || ipi->pending) {
+    return;
+  }
+  ipi->stamp = port_get_timestamp();
+  ipi->sender = port_ThisTask(lib);
+  atomic_release(lib);
+  ipi->pending = 1;
+}
+
+/* Called by the target CPU in its IPI handler. */
+void lat_ipirecv(Lib *lib, const ExecCPU *cpu) {
+  struct LatencyIPI *ipi;
+  unsigned long t;
+
+  ipi = ipiof(lib, cpu);
+  if (ipi == NULL || !ipi->pending) {
+    return;
+  }
+  atomic_acquire(lib);
+  t = port_get_timestamp() - ipi->stamp;
+  iObtainIntLockDisabled(lib, &lib->latencylock);
+  record(&lib->latency[LATIPI], t, cpu->id, cpu->heir, ipi->sender,
+   cpu->thistask);
+  iReleaseIntLockDisabled(lib, &lib->latencylock);
+  ipi->pending = 0;
+}
+
+/*
+ * The histograms and the per-CPU IPI stamps are allocated once,
+ * before the other CPUs are started. The hooks do nothing until
+ * then.
+ */
+void startlatency(Lib *lib) {
+  LatencyStats *lat;
+  struct LatencyIPI *ipi;
+  int n;
+
+  if (!CFG_LATENCY) {
+    return;
+  }
+  n = port_get_ncpu(lib);
+  lat = lAllocMem(lib, NLAT * sizeof *lat, MEMF_CLEAR | MEMF_ANY);
+  ipi = lAllocMem(lib, n * sizeof *ipi, MEMF_CLEAR | MEMF_ANY);
+  KASSERT(lat && ipi);
+  lib->nlatipi = n;
+  atomic_release(lib);
+  lib->latency = lat;
+  lib->latipi = ipi;
+}
+
+int iGetLatency(Lib *lib, int kind, int index, LatencyStats *ls) {
+  int i;
+  int ok;
+
+  if (!CFG_LATENCY) {
+    return 0;
+  }
+  if (kind == LAT_IPI && index == 0) {
+    i = LATIPI;
+  } else if (kind == LAT_WAKEUP && 0 <= index && index < NLATPRI) {
+    i = index;
+  } else {
+    return 0;
+  }
+  if (lib->latency == NULL) {
+    return 0;
+  }
+  lObtainIntLock(lib, &lib->latencylock);
+  ok = lib->latency[i].n != 0;
+  if (ok) {
+    *ls = lib->latency[i];
+  }
+  lReleaseIntLock(lib, &lib->latencylock);
+  return ok;
+}
+
+void iClearLatency(Lib *lib) {
+  if (lib->latency == NULL) {
+    return;
+  }
+  lObtainIntLock(lib, &lib->latencylock);
+  for (int i = 0; i < NLAT; i++) {
+    lib->latency[i] = (LatencyStats) { 0 };
+  }
+  lReleaseIntLock(lib, &lib->latencylock);
+}
+
+static void putfmt(Lib *lib, void (*put)(void *arg, int c), void *arg,
+ const char *fmt, ...) {
+  va_list ap;
+
+  va_start(ap, fmt);
+  lRawDoFmt(lib, put, arg, fmt, ap);
+  va_end(ap);
+}
+
+/* The head line of a histogram, copied under latencylock */
+struct head {
+  unsigned long    n;
+  unsigned long    max;
+  unsigned int     maxcpu;
+  int              pri;
+  char             maxtask[LAT_NAMELEN];
+  char             maxwaker[LAT_NAMELEN];
+  char             maxprev[LAT_NAMELEN];
+};
+
+/*
+ * A LatencyStats is too large for the stack of the caller, so only
+ * the head is copied and the buckets are read one at a time under
+ * latencylock. put is called with the lock released. Samples
+ * recorded meanwhile may show in the buckets but not in n.
+ */
+static int report(Lib *lib, void (*put)(void *arg, int c), void *arg,
+ int i) {
+  const LatencyStats *ls;
+  struct head h;
+
+  ls = &lib->latency[i];
+  lObtainIntLock(lib, &lib->latencylock);
+  h.n = ls->n;
+  h.max = ls->max;
+  h.maxcpu = ls->maxcpu;
+  h.pri = ls->pri;
+  copystr(h.maxtask, ls->maxtask);
+  copystr(h.maxwaker, ls->maxwaker);
+  copystr(h.maxprev, ls->maxprev);
+  lReleaseIntLock(lib, &lib->latencylock);
+  if (h.n == 0) {
+    return 0;
+  }
+  if (i == LATIPI) {
+    putfmt(lib, put, arg, "IPI latency\n");
+  } else {
+    putfmt(lib, put, arg, "wakeup latency, pri %d\n", h.pri);
+  }
+  putfmt(lib, put, arg, "  n %lu, max %lu on cpu%u: %s by %s, "
+   "after %s\n", h.n, h.max, h.maxcpu, h.maxtask, h.maxwaker,
+   h.maxprev);
+  for (int b = 0; b < LAT_NBUCKET; b++) {
+    unsigned long count;
+
+    lObtainIntLock(lib, &lib->latencylock);
+    count = ls->bucket[b];
+    lReleaseIntLock(lib, &lib->latencylock);
+    if (count) {
+      putfmt(lib, put, arg, "  >= %10lu: %lu\n", b ? 1UL << b : 0,
+       count);
+    }
+  }
+  return 1;
+}
+
+void iReportLatency(Lib *lib, void (*put)(void *arg, int c),
+ void *arg) {
+  int n;
+
+  n = 0;
+  /* wakeup histograms in GetLatency() order, then LATIPI */
+  for (int i = 0; lib->latency && i < NLAT; i++) {
+    n += report(lib, put, arg, i);
+  }
+  if (n == 0) {
+    putfmt(lib, put, arg, "no latency samples\n");
+  }
+}
+
@@ -102,6 +102,8 @@ Segment *expungelib(Lib *lib, Library *l) {
   void *mem;
   int size;
 
+  /* Wait for lookups which may have found the removed node. */
+  lSyncRCU(lib);
   mem = l->allocatedmemory;
   size = l->allocatedsize;
   seg = GETOP(l)->Expunge(l);
@@ -118,12 +120,16 @@ void remlib(Lib *lib, Library *l, Mutex *lock) {
   callexpunge = 0;
 
   lObtainMutex(lib, lock);
-  if (l->opencount) {
-    l->flags |= LIBF_DELEXP;
-  } else {
-    iRemove(lib, &l->node);
+  lObtainIntLock(lib, &lib->openlock);
+  /* With opencount 0, the flag prevents new opens. */
+  l->flags |= LIBF_DELEXP;
+  if (l->opencount == 0) {
     callexpunge = 1;
   }
+  lReleaseIntLock(lib, &lib->openlock);
+  if (callexpunge) {
+    iRemove(lib, &l->node);
+  }
   lReleaseMutex(lib, lock);
 
   if (callexpunge) {
@@ -131,9 +137,63 @@ void remlib(Lib *lib, Library *l, Mutex *lock) {
   }
 }
 
+/*
+ * The lookup found l without holding the list lock, so it may be
+ * on its way out: opencount 0 with LIBF_DELEXP set.
+ */
+int incopen(Lib *lib, Library *l) {
+  int ok;
+
+  ok = 0;
+  lObtainIntLock(lib, &lib->openlock);
+  if (l->opencount || (l->flags & LIBF_DELEXP) == 0) {
+    l->opencount++;
+    ok = 1;
+  }
+  lReleaseIntLock(lib, &lib->openlock);
+  return ok;
+}
+
+int decopen(Lib *lib, Library *l, Mutex *lock) {
+  int callexpunge;
+
+  callexpunge = 0;
+  lObtainMutex(lib, lock);
+  lObtainIntLock(lib, &lib->openlock);
+  l->opencount--;
+  if (l->opencount == 0 && l->flags & LIBF_DELEXP) {
+    callexpunge = 1;
+  }
+  lReleaseIntLock(lib, &lib->openlock);
+  if (callexpunge) {
+    iRemove(lib, &l->node);
+  }
+  lReleaseMutex(lib, lock);
+
+  return callexpunge;
+}
+
+/*
+ * A successful open only touches the flags. An open which failed
+ * may have to remove the node from the list, which requires the
+ * list lock.
+ */
+int endopen(Lib *lib, Library *l, Mutex *lock, int ok) {
+  if (ok) {
+    lObtainIntLock(lib, &lib->openlock);
+    /* Open OK so reset delayed expunge hint */
+    l->flags &= ~LIBF_DELEXP;
+    lReleaseIntLock(lib, &lib->openlock);
+    return 0;
+  }
+
+  /* Undo the open. Delayed expunge may still be there. */
+  return decopen(lib, l, lock);
+}
+
 void enqnode(Lib *lib, Node *node, List *list, Mutex *lock) {
   lObtainMutex(lib, lock);
-  iEnqueue(lib, list, node);
+  enqueue_rcu(lib, list, node);
   lReleaseMutex(lib, lock);
 }
 
@@ -156,16 +216,17 @@ Library *iOpenLibrary(Lib *lib, const char *name, int version) {
   int callexpunge;
 
   list = &lib->liblist;
-  lObtainMutex(lib, &lib->liblock);
+  /* Lookup is lock-free so concurrent opens can proceed. */
+  lObtainRCU(lib);
   do {
     l = (Library *) lFindName(lib, list, name);
     list = (List *) l;
   } while (l && l->version < version);
-  if (l) {
-    /* Prevent library from going away while calling Open(). */
-    l->opencount++;
+  /* Prevent library from going away while calling Open(). */
+  if (l && incopen(lib, l) == 0) {
+    l = NULL;
   }
-  lReleaseMutex(lib, &lib->liblock);
+  lReleaseRCU(lib);
 
   if (l == NULL) {
     return NULL;
@@ -174,8 +235,6 @@ Library *iOpenLibrary(Lib *lib, const char *name, int version) {
   /* Do the Open() without lock. */
   openedl = GETOP(l)->Open(l);
 
-  callexpunge = 0;
-  lObtainMutex(lib, &lib->liblock);
   /*
    * NOTE: Since we last changed the invariants under liblock
    * before the Open(l) call, many things could have happened,
@@ -183,18 +242,7 @@ Library *iOpenLibrary(Lib *lib, const char *name, int version) {
    * RemLibrary. In particualr, a delayed expunge could have
    * been requested, so we must check the expunge condition.
    */
-  if (openedl) {
-    /* Open OK so reset delayed expunge hint */
-    l->flags &= ~LIBF_DELEXP;
-  } else {
-    /* Undo the open. Delayed expunge may still be there. */
-    l->opencount--;
-    if (l->opencount == 0 && l->flags & LIBF_DELEXP) {
-      iRemove(lib, &l->node);
-      callexpunge = 1;
-    }
-  }
-  lReleaseMutex(lib, &lib->liblock);
+  callexpunge = endopen(lib, l, &lib->liblock, openedl != NULL);
 
   if (callexpunge) {
     expungelib(lib, l);
@@ -208,14 +256,7 @@ void iCloseLibrary(Lib *lib, Library *l) {
 
   GETOP(l)->Close(l);
 
-  callexpunge = 0;
-  lObtainMutex(lib, &lib->liblock);
-  l->opencount--;
-  if (l->opencount == 0 && l->flags & LIBF_DELEXP) {
-    iRemove(lib, &l->node);
-    callexpunge = 1;
-  }
-  lReleaseMutex(lib, &lib->liblock);
+  callexpunge = decopen(lib, l, &lib->liblock);
 
   if (callexpunge) {
     expungelib(lib, l);
@@ -0,0 +1,82 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Lightweight tasks on the work queues */
+
+#include <priv.h>
+
+/*
+ * A LightTask is a Work item. It is queued when it is added and
+ * when it gets a signal it waits for, and code() runs on the
+ * worker stack of a CPU until it returns.
+ *
+ * sigwait is only non-zero while the LightTask is waiting, and
+ * the side which clears it under lt->lock queues the Work. So it
+ * is queued once per wakeup and code() calls never overlap, also
+ * when signals come from other CPUs. The lock is per LightTask
+ * since the Work can be queued on any CPU, and LightTasks do not
+ * contend with each other.
+ */
+
+/* Called with lt->lock. Return 1 if lt shall be queued. */
+static int wake(LightTask *lt) {
+  unsigned int got;
+
+  got = lt->sigrecvd & lt->sigwait;
+  if (got == 0) {
+    return 0;
+  }
+  lt->sigrecvd &= ~got;
+  lt->sigwait = 0;
+  lt->signals = got;
+  return 1;
+}
+
+static void runlight(Lib *lib, Work *work) {
+  LightTask *lt;
+  unsigned int sigmask;
+  int queue;
+
+  lt = (LightTask *) work;
+  sigmask = lt->code(lib, lt);
+  if (sigmask == 0) {
+    /* LT_END() */
+    return;
+  }
+  if (sigmask & LIGHTF_YIELD) {
+    lt->signals = 0;
+    lQueueWork(lib, work, WORK_ANYCPU);
+    return;
+  }
+  lObtainIntLock(lib, &lt->lock);
+  lt->sigwait = sigmask;
+  queue = wake(lt);
+  lReleaseIntLock(lib, &lt->lock);
+  if (queue) {
+    lQueueWork(lib, work, WORK_ANYCPU);
+  }
+}
+
+void iAddLightTask(Lib *lib, LightTask *lt) {
+  lt->work.code = runlight;
+  lt->work.queue = NULL;
+  lInitIntLock(lib, &lt->lock);
+  lt->resume = 0;
+  lt->signals = 0;
+  lt->sigwait = 0;
+  lt->sigrecvd = 0;
+  lQueueWork(lib, &lt->work, WORK_ANYCPU);
+}
+
+void iSignalLightTask(Lib *lib, LightTask *lt, unsigned int sigmask) {
+  int queue;
+
+  lObtainIntLock(lib, &lt->lock);
+  lt->sigrecvd |= sigmask;
+  queue = wake(lt);
+  lReleaseIntLock(lib, &lt->lock);
+  if (queue) {
+    lQueueWork(lib, &lt->work, WORK_ANYCPU);
+  }
+}
+
@@ -95,6 +95,19 @@ Node *iRemTail(Lib *lib, List *list) {
   return oldtail;
 }
 
+void movelist(Lib *lib, List *dst, List *src) {
+  Node *first = src->head;
+  Node *last = src->tailpred;
+  if (first->succ == NULL) {
+    return;
+  }
+  first->pred = dst->tailpred;
+  dst->tailpred->succ = first;
+  last->succ = (Node *) &dst->tail;
+  dst->tailpred = last;
+  iNewList(lib, src);
+}
+
 static int c_strcmp(const char *s1, const char *s2) {
   while (*s1 == *s2++) {
     if (*s1++ == '\0') {
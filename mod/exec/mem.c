@@ -170,7 +170,7 @@ void iAddMemHeader(
   enqnode(lib, &mh->node, &lib->memlist, &lib->memlock);
 }
 
-void *iAllocMem(Lib *lib, size_t numbytes, int attr) {
+static void *allocmem(Lib *lib, size_t numbytes, int attr) {
   List *list;
   void *p;
 
@@ -189,6 +189,18 @@ void *iAllocMem(Lib *lib, size_t numbytes, int attr) {
   }
   lReleaseMutex(lib, &lib->memlock);
 
+  return p;
+}
+
+/* Ended tasks parked by CreateTask() are given back on failure. */
+void *iAllocMem(Lib *lib, size_t numbytes, int attr) {
+  void *p;
+
+  p = allocmem(lib, numbytes, attr);
+  if (p == NULL && flushtaskcache(lib)) {
+    p = allocmem(lib, numbytes, attr);
+  }
+
   if (p && (attr & MEMF_CLEAR)) {
     lMemSet(lib, p, 0, numbytes);
   }
@@ -253,7 +265,7 @@ size_t iAvailMem(Lib *lib, int attr) {
   sum = 0;
   list = &lib->memlist;
 
-  lObtainMutex(lib, &lib->memlock);
+  lObtainMutexShared(lib, &lib->memlock);
   for (Node *node = list->head; node->succ; node = node->succ) {
     MemHeader *mh = (MemHeader *) node;
     if ((mh->attr & attr) == (attr & MEMF_TYPE)) {
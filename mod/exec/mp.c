@@ -3,6 +3,7 @@
 
 #include <priv.h>
 #include <port.h>
+#include <exec/atomic.h>
 
 static void schedule(Lib *lib);
 
@@ -40,7 +41,7 @@ static void process_removing(Lib *lib, ExecCPU *cpu) {
   rem->state = TS_REMOVED;
   lReleaseIntLock(lib, &lib->tasklock);
   cpu->removing = NULL;
-  lSignal(lib, lib->cleantask, SIGF_CLEANUP);
+  lQueueWork(lib, &lib->cleanwork, WORK_ANYCPU);
 }
 
 void task_entry(Lib *lib) {
@@ -54,7 +55,12 @@ void task_entry(Lib *lib) {
   cpu = getcpu(lib, 1);
 
   task = port_ThisTask(lib);
+#if CFG_TASKSTATS
+  stat_switchin(lib, task);
+#endif
   if (task->node.pri == TASK_PRI_IDLE) {
+    /* Off the isrstack now, see start_on_secondary(). */
+    port_really_enable_interrupts();
     /*
      * The CPU specific IDLE task is special. It is the first
      * task to run and it does so here before the CPU has been
@@ -114,6 +120,7 @@ static void InitCPU(Lib *lib, ExecCPU *cpu, unsigned int id) {
   cpu->heir = idletask;
   cpu->thistask = idletask;
   cpu->removing = NULL;
+  iNewList(lib, &cpu->softint);
 }
 
 static void CreateCPU(Lib *lib, unsigned long id,
@@ -123,7 +130,8 @@ static void CreateCPU(Lib *lib, unsigned long id,
   cpu = port_alloc_cpu(lib);
   KASSERT(cpu);
   if (id == creator) {
-    port_set_cpu(cpu);
+    /* No task yet: the Mutex functions are still the empty ones. */
+    port_set_cpu(cpu, NULL);
   }
   InitCPU(lib, cpu, id);
   lObtainIntLock(lib, &lib->tasklock);
@@ -159,9 +167,18 @@ ExecCPU *findcpu(Lib *lib, unsigned int id) {
   return NULL;
 }
 
+/*
+ * Until the IDLE task takes over, ThisTask is the bootstrap
+ * context. It is in no task list, so checkstate() catches task
+ * functions called from here. The context is never switched back
+ * to, so all CPUs share it: the stack pointer port_switch_tasks()
+ * stores in none.arch is not read, and state stays TS_INVALID.
+ * It is static since a Task is large for the boot stack.
+ */
+static Task none;
+
 /* Must be called by the local CPU */
 void start_on_secondary(Lib *lib, unsigned long id) {
-  Task none;
   ExecCPU *cpu;
 
   lObtainIntLock(lib, &lib->tasklock);
@@ -173,12 +190,12 @@ void start_on_secondary(Lib *lib, unsigned long id) {
     while (1);
   }
 
-  port_set_cpu(cpu);
+  port_set_cpu(cpu, &none);
   port_enable_ipi(cpu->id);
-  port_really_enable_interrupts();
   /*
-   * FIXME: isrstack is same as current stack. A potential fix
-   * is to enable interrupts in the idle task.
+   * We run on the isrstack, which the first interrupt would
+   * take over. task_entry() enables interrupts for the IDLE
+   * task instead.
    */
   port_switch_tasks(&none, cpu->idle);
   /* we will continue in task_entry for the IDLE task */
@@ -217,6 +234,10 @@ ExecCPU *switch_tasks(Lib *lib, ExecCPU *cpu) {
   thistask = cpu->thistask;
   KASSERT(thistask);
 
+  /* No RCU reader is active on this CPU: a quiescent state. */
+  port_memory_barrier();
+  cpu->rcuepoch = lib->rcuepoch;
+
   do {
     Task *heir;
     int level;
@@ -224,6 +245,8 @@ ExecCPU *switch_tasks(Lib *lib, ExecCPU *cpu) {
     check_canaries(lib, &thistask->canaries);
     checkstack(lib, thistask);
     cpu->switch_needed = 0;
+    /* Pairs with the release in setheir(). */
+    atomic_acquire(lib);
     heir = cpu->heir;
     KASSERT(heir->state != TS_REMOVED);
     if (heir == thistask) {
@@ -235,6 +258,14 @@ ExecCPU *switch_tasks(Lib *lib, ExecCPU *cpu) {
       KASSERT(cpu->removing == NULL);
       cpu->removing = thistask;
     }
+#if CFG_TASKSTATS
+    stat_switchout(lib, thistask);
+#endif
+#if CFG_LATENCY
+    if (heir->waker) {
+      lat_wakeup(lib, heir, thistask, cpu->id);
+    }
+#endif
     port_really_enable_interrupts();
     cpu = NULL;
     /* run as "thistask" */
@@ -246,6 +277,9 @@ ExecCPU *switch_tasks(Lib *lib, ExecCPU *cpu) {
     level = port_disable_interrupts();
     KASSERT(port_interrupt_is_enabled(level));
     (void) level;
+#if CFG_TASKSTATS
+    stat_switchin(lib, thistask);
+#endif
   } while (cpu->switch_needed);
 
   KASSERT(thistask->state != TS_REMOVED);
@@ -267,17 +301,36 @@ ExecCPU *switch_tasks_if_needed(Lib *lib, ExecCPU *cpu) {
   return cpu;
 }
 
+/*
+ * Undo one switch_disable level taken by the local CPU and do a
+ * pending task switch if it was the last one. Called with
+ * interrupts disabled. level is the interrupt level which the
+ * caller will restore.
+ */
+void switch_enable(Lib *lib, ExecCPU *cpu, int level) {
+  cpu->switch_disable--;
+  if (cpu->switch_disable == 0 && port_interrupt_is_enabled(level)) {
+    KASSERT(cpu->isr_nest == 0);
+    if (cpu->switch_needed) {
+      cpu->switch_disable = 1;
+      cpu = switch_tasks(lib, cpu);
+      cpu->switch_disable = 0;
+    }
+  }
+}
+
+/*
+ * The port keeps the running task in a register which
+ * port_switch_tasks() loads. A task can only continue on another
+ * CPU by way of port_switch_tasks() there, so the register always
+ * holds the task which reads it and interrupts need not be
+ * disabled.
+ */
 Task *port_ThisTask(Lib *lib) {
   Task *task;
-  ExecCPU *cpu;
-  int level;
 
-  level = port_disable_interrupts();
-  cpu = port_get_cpu();
-  KASSERT(cpu);
-  task = cpu->thistask;
+  task = port_get_thistask();
   KASSERT(task);
-  port_enable_interrupts(level);
   return task;
 }
 
@@ -382,9 +435,23 @@ static int isinlist(List *list, Node *target) {
   return 0;
 }
 
+static int isheir(Lib *lib, const Task *task) {
+  for (Node *node = lib->cpuonline.head; node->succ;
+   node = node->succ) {
+    if (((ExecCPU *) node)->heir == task) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
 static void setheir(Lib *lib, ExecCPU *cpu, Task *heir) {
   cpu->heir = heir;
-  /* TODO: barrier for heir? */
+  if (CFG_LATENCY && cpu != port_get_cpu()) {
+    lat_ipisend(lib, cpu);
+  }
+  /* Make heir visible before the CPU is told to switch. */
+  atomic_release(lib);
   if (cpu == port_get_cpu()) {
     cpu->switch_needed = 1;
   } else {
@@ -477,8 +544,58 @@ static void schedule(Lib *lib) {
   lReleaseIntLock(lib, &lib->tasklock);
 }
 
-void announce_ipi(void) {
+/*
+ * Pick the first ready task with the priority of the caller which
+ * is not heir on some CPU, and put the caller behind its peers.
+ * Only the caller and that task change places, so the heir is set
+ * here without a schedule() pass.
+ */
+void iYield(Lib *lib) {
+  ExecCPU *cpu;
+  Task *task;
+  Node *peer;
+  int level;
+
+  level = port_disable_interrupts();
+  KASSERT(port_interrupt_is_enabled(level));
+  cpu = getcpu(lib, 0);
+  checkstate(lib, 1<<TS_READY);
+  task = cpu->thistask;
+  peer = NULL;
+
+  iObtainIntLockDisabled(lib, &lib->tasklock);
+  if (cpu->heir == task && task->node.pri != TASK_PRI_IDLE) {
+    for (Node *node = lib->taskready.head; node->succ;
+     node = node->succ) {
+      if (node->pri < task->node.pri) {
+        break;
+      }
+      if (node->pri == task->node.pri && !isheir(lib, (Task *) node)) {
+        peer = node;
+        break;
+      }
+    }
+  }
+  if (peer) {
+    iRemove(lib, &task->node);
+    iEnqueue(lib, &lib->taskready, &task->node);
+    setheir(lib, cpu, (Task *) peer);
+  }
+  iReleaseIntLockDisabled(lib, &lib->tasklock);
+
+  if (cpu->switch_needed) {
+    cpu->switch_disable = 1;
+    cpu = switch_tasks(lib, cpu);
+    cpu->switch_disable = 0;
+  }
+  port_enable_interrupts(level);
+}
+
+void announce_ipi(Lib *lib) {
   ExecCPU *cpu = port_get_cpu();
+  if (CFG_LATENCY) {
+    lat_ipirecv(lib, cpu);
+  }
   cpu->switch_needed = 1;
 }
 
@@ -2,19 +2,112 @@
 /* Copyright 2019-2022 Martin Åberg */
 
 #include <priv.h>
+#include <exec/atomic.h>
 
-static void putit(Lib *lib, MsgPort *port, Message *msg, int type) {
-  lObtainIntLock(lib, &port->inv.lock);
-  msg->node.type = type;
-  iAddTail(lib, &port->inv.msglist, &msg->node);
-  lReleaseIntLock(lib, &port->inv.lock);
+/*
+ * MPF_LOCKFREE ports
+ *
+ * Senders push on the pending stack with compare-and-swap. The
+ * receiver takes the whole stack with one swap, so a node can not
+ * be removed and pushed again while a sender is in its CAS (no
+ * ABA problem). The stack is reversed to restore FIFO order and
+ * appended to msglist, which only the receiver touches.
+ */
+
+/*
+ * Push the chain last..first, linked by succ in LIFO order.
+ * Return 1 if the pending stack was empty.
+ */
+static int pushchain(
+  Lib *lib,
+  MsgPort *port,
+  Node *first,
+  Node *last
+) {
+  void *head;
+  void *old;
+
+  old = port->pending;
+  do {
+    head = old;
+    first->succ = head;
+    old = atomic_cas_ptr(lib, &port->pending, head, last);
+  } while (old != head);
+  return head == NULL;
+}
+
+static void drain(Lib *lib, MsgPort *port) {
+  Node *node;
+  Node *succ;
+  Node *fifo;
 
+  if (port->pending == NULL) {
+    return;
+  }
+  node = atomic_swap_ptr(lib, &port->pending, NULL);
+  fifo = NULL;
+  while (node) {
+    succ = node->succ;
+    node->succ = fifo;
+    fifo = node;
+    node = succ;
+  }
+  while (fifo) {
+    succ = fifo->succ;
+    iAddTail(lib, &port->inv.msglist, fifo);
+    fifo = succ;
+  }
+}
+
+/*
+ * Signal coalescing
+ *
+ * The port task is only signaled when the port goes from empty to
+ * non-empty. A receiver takes all messages before it waits for the
+ * signal again (WaitPort() checks the port first), so a signal for
+ * a message on a non-empty port is redundant: the message is found
+ * together with the earlier ones.
+ *
+ * WaitMsg() waits with other messages left on the port, so it sets
+ * port->waiting to get a signal for each message. The flag is set
+ * before the port is examined and read after the message is added,
+ * both under inv.lock or both after a full barrier, so at least one
+ * side sees the other.
+ */
+static void signalport(Lib *lib, MsgPort *port, int wasempty) {
   /* FIXME: port and sigtask may have disappeared */
+  if (port->sigtask == NULL && port->siglight == NULL) {
+    return;
+  }
+  if (!wasempty) {
+    atomic_add(lib, &port->suppressed, 1);
+    return;
+  }
   if (port->sigtask) {
     lSignal(lib, port->sigtask, 1U << port->sigbit);
+  } else {
+    lSignalLightTask(lib, port->siglight, 1U << port->sigbit);
   }
 }
 
+static void putit(Lib *lib, MsgPort *port, Message *msg, int type) {
+  int wasempty;
+
+  if (port->flags & MPF_LOCKFREE) {
+    msg->node.type = type;
+    wasempty = pushchain(lib, port, &msg->node, &msg->node);
+    wasempty |= port->waiting;
+  } else {
+    lObtainIntLock(lib, &port->inv.lock);
+    wasempty = iGetHead(lib, &port->inv.msglist) == NULL;
+    wasempty |= port->waiting;
+    msg->node.type = type;
+    iAddTail(lib, &port->inv.msglist, &msg->node);
+    lReleaseIntLock(lib, &port->inv.lock);
+  }
+  signalport(lib, port, wasempty);
+}
+
 void iPutMsg(Lib *lib, MsgPort *port, Message *msg) {
   putit(lib, port, msg, NT_MESSAGE);
 }
@@ -22,6 +115,15 @@ void iPutMsg(Lib *lib, MsgPort *port, Message *msg) {
 Message *iGetMsg(Lib *lib, MsgPort *port) {
   Message *msg;
 
+  if (port->flags & MPF_LOCKFREE) {
+    msg = (Message *) iRemHead(lib, &port->inv.msglist);
+    if (msg == NULL) {
+      drain(lib, port);
+      msg = (Message *) iRemHead(lib, &port->inv.msglist);
+    }
+    return msg;
+  }
+
   lObtainIntLock(lib, &port->inv.lock);
   msg = (Message *) iRemHead(lib, &port->inv.msglist);
   lReleaseIntLock(lib, &port->inv.lock);
@@ -29,6 +131,59 @@ Message *iGetMsg(Lib *lib, MsgPort *port) {
   return msg;
 }
 
+void iPutMsgs(Lib *lib, MsgPort *port, List *list) {
+  Node *node;
+  Node *prev;
+  int wasempty;
+
+  if (list->head->succ == NULL) {
+    return;
+  }
+  /* The messages are not visible to the receiver yet. */
+  for (node = list->head; node->succ; node = node->succ) {
+    node->type = NT_MESSAGE;
+  }
+
+  if (port->flags & MPF_LOCKFREE) {
+    Node *succ;
+
+    /* Relink in LIFO order, drain() restores it. */
+    prev = NULL;
+    for (node = list->head; node->succ; node = succ) {
+      succ = node->succ;
+      node->succ = prev;
+      prev = node;
+    }
+    wasempty = pushchain(lib, port, list->head, prev);
+    wasempty |= port->waiting;
+    iNewList(lib, list);
+  } else {
+    lObtainIntLock(lib, &port->inv.lock);
+    wasempty = iGetHead(lib, &port->inv.msglist) == NULL;
+    wasempty |= port->waiting;
+    movelist(lib, &port->inv.msglist, list);
+    lReleaseIntLock(lib, &port->inv.lock);
+  }
+  signalport(lib, port, wasempty);
+}
+
+int iGetMsgList(Lib *lib, MsgPort *port, List *list) {
+  int ret;
+
+  if (port->flags & MPF_LOCKFREE) {
+    drain(lib, port);
+    ret = iGetHead(lib, &port->inv.msglist) != NULL;
+    movelist(lib, list, &port->inv.msglist);
+    return ret;
+  }
+
+  lObtainIntLock(lib, &port->inv.lock);
+  ret = iGetHead(lib, &port->inv.msglist) != NULL;
+  movelist(lib, list, &port->inv.msglist);
+  lReleaseIntLock(lib, &port->inv.lock);
+  return ret;
+}
+
 int iReplyMsg(Lib *lib, Message *msg) {
   MsgPort *port;
 
@@ -46,9 +201,14 @@ Message *iWaitPort(Lib *lib, MsgPort *const port) {
   Message *msg;
 
   while (1) {
-    lObtainIntLock(lib, &port->inv.lock);
-    msg = (Message *) iGetHead(lib, &port->inv.msglist);
-    lReleaseIntLock(lib, &port->inv.lock);
+    if (port->flags & MPF_LOCKFREE) {
+      drain(lib, port);
+      msg = (Message *) iGetHead(lib, &port->inv.msglist);
+    } else {
+      lObtainIntLock(lib, &port->inv.lock);
+      msg = (Message *) iGetHead(lib, &port->inv.msglist);
+      lReleaseIntLock(lib, &port->inv.lock);
+    }
     if (msg) {
       break;
     }
@@ -57,21 +217,52 @@ Message *iWaitPort(Lib *lib, MsgPort *const port) {
   return msg;
 }
 
+/*
+ * The type is set before the push, so NT_REPLYMSG does not mean
+ * that msg can be found yet. Return 1 if msg was removed.
+ */
+static int lockfree_remove(Lib *lib, MsgPort *port, Message *msg) {
+  Node *node;
+
+  if (msg->node.type != NT_REPLYMSG) {
+    return 0;
+  }
+  drain(lib, port);
+  for (node = port->inv.msglist.head; node->succ; node = node->succ) {
+    if (node == &msg->node) {
+      iRemove(lib, node);
+      return 1;
+    }
+  }
+  return 0;
+}
+
 void iWaitMsg(Lib *lib, Message *msg) {
   MsgPort *port;
   unsigned int sigmask;
 
   port = msg->replyport;
   sigmask = 1U << port->sigbit;
+  if (port->flags & MPF_LOCKFREE) {
+    atomic_swap(lib, &port->waiting, 1);
+    while (!lockfree_remove(lib, port, msg)) {
+      lWait(lib, sigmask);
+    }
+    port->waiting = 0;
+    return;
+  }
   while (1) {
     /* lock so type-and-on-port invariant holds */
     lObtainIntLock(lib, &port->inv.lock);
     if (msg->node.type == NT_REPLYMSG) {
       /* msg is now in port */
       iRemove(lib, &msg->node);
+      port->waiting = 0;
       lReleaseIntLock(lib, &port->inv.lock);
       return;
     }
+    /* Other messages may be left on the port. */
+    port->waiting = 1;
     lReleaseIntLock(lib, &port->inv.lock);
     lWait(lib, sigmask);
   }
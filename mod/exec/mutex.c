@@ -7,15 +7,11 @@
 void iInitMutex(Lib *lib, Mutex *ctx) {
   iNewList(lib, &ctx->waitqueue);
   ctx->nest = 0;
+  ctx->shared = 0;
   lInitIntLock(lib, &ctx->lock);
   ctx->owner = NULL;
 }
 
-typedef struct {
-  Node node;
-  Task *task;
-} Waiter;
-
 /*
  * ObtainMutex() and ReleaseMutex() are called by init code
  * before ThisTask can be retrieved (via Cpu). Such calls will
@@ -24,82 +20,151 @@ typedef struct {
  */
 void iObtainMutex(Lib *lib, Mutex *ctx) {
 }
+void iObtainMutexShared(Lib *lib, Mutex *ctx) {
+}
 void iReleaseMutex(Lib *lib, Mutex *ctx) {
 }
 
-void iObtainMut(Lib *lib, Mutex *ctx) {
+/*
+ * Try to get the Mutex for thistask. Must be called with
+ * ctx->lock held.
+ *
+ * A shared request is not granted if there is anyone in the
+ * waitqueue. That prevents a stream of shared owners from
+ * starving an exclusive waiter.
+ *
+ * return: 1 if the Mutex was obtained, else 0
+ */
+static int tryobtain(Lib *lib, Mutex *ctx, Task *thistask, int shared) {
+  if (ctx->owner == thistask) {
+    /* Nested obtain, also when shared is requested. */
+    ctx->nest++;
+    KASSERT(ctx->nest);
+    return 1;
+  }
+  if (ctx->owner != NULL) {
+    return 0;
+  }
+  if (shared) {
+    if (iGetHead(lib, &ctx->waitqueue)) {
+      return 0;
+    }
+    ctx->shared++;
+    return 1;
+  }
+  if (ctx->shared) {
+    return 0;
+  }
+  KASSERT(ctx->nest == 0);
+  ctx->owner = thistask;
+  return 1;
+}
+
+static void obtain(Lib *lib, Mutex *ctx, int shared) {
   Waiter waiter;
   Task *thistask;
-  Task *previous_owner;
+  int gotit;
 
   thistask = port_ThisTask(lib);
 
   lObtainIntLock(lib, &ctx->lock);
-  {
-    previous_owner = ctx->owner;
-    if (previous_owner == NULL) {
-      ctx->owner = thistask;
-    }
-  }
+  gotit = tryobtain(lib, ctx, thistask, shared);
   lReleaseIntLock(lib, &ctx->lock);
 
-  if (previous_owner == NULL) {
-    KASSERT(ctx->nest == 0);
+  if (gotit) {
     return;
   }
 
   waiter.task = thistask;
+  waiter.shared = shared;
   lClearSignal(lib, SIGF_SINGLE);
 
   lObtainIntLock(lib, &ctx->lock);
-  {
-    if (ctx->owner == NULL) {
-      ctx->owner = thistask;
-      KASSERT(ctx->nest == 0);
-      /* We got it after testing the first time. */
-      lReleaseIntLock(lib, &ctx->lock);
-      return;
-    }
-    if (ctx->owner == thistask) {
-      lReleaseIntLock(lib, &ctx->lock);
-      ctx->nest++;
-      KASSERT(ctx->nest);
-      return;
-    }
-    iAddTail(lib, &ctx->waitqueue, (Node *) &waiter);
+  /* We may get it after testing the first time. */
+  gotit = tryobtain(lib, ctx, thistask, shared);
+  if (!gotit) {
+    iAddTail(lib, &ctx->waitqueue, &waiter.node);
   }
   lReleaseIntLock(lib, &ctx->lock);
 
+  if (gotit) {
+    return;
+  }
+
+  /* ReleaseMutex() has transferred ownership to us. */
   lWait(lib, SIGF_SINGLE);
   KASSERT(ctx->nest == 0);
-  KASSERT(ctx->owner == thistask);
+  if (shared) {
+    KASSERT(ctx->owner == NULL);
+    KASSERT(ctx->shared);
+  } else {
+    KASSERT(ctx->owner == thistask);
+  }
 }
 
-void iReleaseMut(Lib *lib, Mutex *ctx) {
-  Task *sigtask;
+void iObtainMut(Lib *lib, Mutex *ctx) {
+  obtain(lib, ctx, 0);
+}
+
+void iObtainMutShared(Lib *lib, Mutex *ctx) {
+  obtain(lib, ctx, 1);
+}
 
-  KASSERT(port_ThisTask(lib) == ctx->owner);
-  if (ctx->nest) {
-    ctx->nest--;
+/*
+ * Transfer ownership of a free Mutex to the first waiter. If
+ * the first waiter wants shared access, then all consecutive
+ * shared waiters at the head of the waitqueue become owners.
+ * Tasks to signal are moved to the wake list. Must be called
+ * with ctx->lock held.
+ */
+static void handoff(Lib *lib, Mutex *ctx, List *wake) {
+  Waiter *waiter;
+
+  KASSERT(ctx->owner == NULL);
+  KASSERT(ctx->shared == 0);
+  waiter = (Waiter *) iGetHead(lib, &ctx->waitqueue);
+  if (waiter == NULL) {
     return;
   }
+  if (!waiter->shared) {
+    iRemove(lib, &waiter->node);
+    ctx->owner = waiter->task;
+    iAddTail(lib, wake, &waiter->node);
+    return;
+  }
+  while (waiter && waiter->shared) {
+    iRemove(lib, &waiter->node);
+    ctx->shared++;
+    iAddTail(lib, wake, &waiter->node);
+    waiter = (Waiter *) iGetHead(lib, &ctx->waitqueue);
+  }
+}
+
+void iReleaseMut(Lib *lib, Mutex *ctx) {
+  Task *thistask;
+  List wake;
 
-  sigtask = NULL;
+  thistask = port_ThisTask(lib);
+  iNewList(lib, &wake);
 
   lObtainIntLock(lib, &ctx->lock);
-  {
-    Waiter *waiter;
-
-    waiter = (Waiter *) iRemHead(lib, &ctx->waitqueue);
-    if (waiter) {
-      sigtask = waiter->task;
+  if (ctx->owner == thistask) {
+    if (ctx->nest) {
+      ctx->nest--;
+      lReleaseIntLock(lib, &ctx->lock);
+      return;
     }
-    ctx->owner = sigtask;
+    ctx->owner = NULL;
+  } else {
+    /* Not the exclusive owner so it must be a shared owner. */
+    KASSERT(ctx->owner == NULL);
+    KASSERT(ctx->shared);
+    ctx->shared--;
+  }
+  if (ctx->owner == NULL && ctx->shared == 0) {
+    handoff(lib, ctx, &wake);
   }
   lReleaseIntLock(lib, &ctx->lock);
 
-  if (sigtask) {
-    lSignal(lib, sigtask, SIGF_SINGLE);
-  }
+  wakeall(lib, &wake);
 }
-
@@ -0,0 +1,162 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+#ifndef EXEC_ATOMIC_H
+#define EXEC_ATOMIC_H
+
+/*
+ * Inline atomic operations
+ *
+ * Where the compiler generates the atomic instructions inline,
+ * these functions use them directly. Otherwise they call the
+ * exec.library functions AtomicCompareSwap() etc which are
+ * implemented for each port. Read-modify-write operations return
+ * the previous value and are full memory barriers.
+ *
+ * Include exec/libcall.h before this file.
+ *
+ * NOTE: On AArch64 the compiler must not use out-of-line atomics
+ * (-mno-outline-atomics) since there is no libgcc helper support.
+ */
+
+#include <exec/mutex.h>
+
+#if defined(__riscv_atomic) || defined(__aarch64__)
+# define EXEC_ATOMIC_INLINE 1
+#else
+# define EXEC_ATOMIC_INLINE 0
+#endif
+
+#if EXEC_ATOMIC_INLINE
+# define ATOMIC_RMW(op, p, val) \
+  __atomic_##op(p, val, __ATOMIC_SEQ_CST)
+#endif
+
+static inline AtomicInteger atomic_cas(
+  struct ExecBase *lib,
+  volatile AtomicInteger *p,
+  AtomicInteger old,
+  AtomicInteger new
+) {
+#if EXEC_ATOMIC_INLINE
+  (void) lib;
+  __atomic_compare_exchange_n(p, &old, new, 0, __ATOMIC_SEQ_CST,
+   __ATOMIC_SEQ_CST);
+  return old;
+#else
+  return lAtomicCompareSwap(lib, p, old, new);
+#endif
+}
+
+static inline AtomicInteger atomic_swap(
+  struct ExecBase *lib,
+  volatile AtomicInteger *p,
+  AtomicInteger val
+) {
+#if EXEC_ATOMIC_INLINE
+  (void) lib;
+  return ATOMIC_RMW(exchange_n, p, val);
+#else
+  return lAtomicSwap(lib, p, val);
+#endif
+}
+
+static inline AtomicInteger atomic_add(
+  struct ExecBase *lib,
+  volatile AtomicInteger *p,
+  AtomicInteger val
+) {
+#if EXEC_ATOMIC_INLINE
+  (void) lib;
+  return ATOMIC_RMW(fetch_add, p, val);
+#else
+  return lAtomicAdd(lib, p, val);
+#endif
+}
+
+static inline AtomicInteger atomic_and(
+  struct ExecBase *lib,
+  volatile AtomicInteger *p,
+  AtomicInteger val
+) {
+#if EXEC_ATOMIC_INLINE
+  (void) lib;
+  return ATOMIC_RMW(fetch_and, p, val);
+#else
+  return lAtomicAnd(lib, p, val);
+#endif
+}
+
+static inline AtomicInteger atomic_or(
+  struct ExecBase *lib,
+  volatile AtomicInteger *p,
+  AtomicInteger val
+) {
+#if EXEC_ATOMIC_INLINE
+  (void) lib;
+  return ATOMIC_RMW(fetch_or, p, val);
+#else
+  return lAtomicOr(lib, p, val);
+#endif
+}
+
+static inline void *atomic_cas_ptr(
+  struct ExecBase *lib,
+  void *volatile *p,
+  void *old,
+  void *new
+) {
+#if EXEC_ATOMIC_INLINE
+  (void) lib;
+  __atomic_compare_exchange_n(p, &old, new, 0, __ATOMIC_SEQ_CST,
+   __ATOMIC_SEQ_CST);
+  return old;
+#else
+  return lAtomicCompareSwapPtr(lib, p, old, new);
+#endif
+}
+
+static inline void *atomic_swap_ptr(
+  struct ExecBase *lib,
+  void *volatile *p,
+  void *val
+) {
+#if EXEC_ATOMIC_INLINE
+  (void) lib;
+  return ATOMIC_RMW(exchange_n, p, val);
+#else
+  return lAtomicSwapPtr(lib, p, val);
+#endif
+}
+
+static inline void atomic_acquire(struct ExecBase *lib) {
+#if EXEC_ATOMIC_INLINE
+  (void) lib;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+#else
+  lAtomicAcquire(lib);
+#endif
+}
+
+static inline void atomic_release(struct ExecBase *lib) {
+#if EXEC_ATOMIC_INLINE
+  (void) lib;
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+#else
+  lAtomicRelease(lib);
+#endif
+}
+
+static inline void atomic_fence(struct ExecBase *lib) {
+#if EXEC_ATOMIC_INLINE
+  (void) lib;
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#else
+  lAtomicFence(lib);
+#endif
+}
+
+#undef ATOMIC_RMW
+
+#endif
+
@@ -11,6 +11,7 @@
 struct ExecBase;
 struct Task;
 struct IntList;
+struct LatencyIPI;
 
 struct Interrupt {
   struct Node      node;
@@ -18,6 +19,92 @@ struct Interrupt {
   void           (*code)(struct ExecBase *lib, void *data);
 };
 
+/* Interrupt server which runs in a task, see AddIntThread() */
+struct IntThread {
+  /* code, data and node.name are set by the caller */
+  struct Interrupt interrupt;
+  /* private */
+  struct Interrupt server;
+  struct Task     *task;
+  struct Task     *owner;
+  int              intnum;
+  int              sigbit;
+  volatile AtomicInteger pending;
+  volatile int     quit;
+};
+
+/* Deferred work item, see QueueWork() */
+struct Work {
+  /* node.type is NT_WORK while queued */
+  struct Node      node;
+  void            *data;
+  void           (*code)(struct ExecBase *lib, struct Work *work);
+  /* private: WorkQueue while queued */
+  void *volatile   queue;
+};
+
+/* QueueWork() cpu argument */
+#define WORK_ANYCPU (-1)
+
+/*
+ * Task without a stack of its own, see AddLightTask(). code() runs
+ * on the work queue stack of a CPU and returns the signals it waits
+ * for. The caller sets code, and optionally work.data and
+ * work.node.name.
+ */
+struct LightTask {
+  struct Work      work;
+  unsigned int   (*code)(struct ExecBase *lib, struct LightTask *lt);
+  /* resume point for the LT_ macros */
+  int              resume;
+  /* signals which woke code() up, like the return of Wait() */
+  unsigned int     signals;
+  /* private: sigwait and sigrecvd are protected by lock */
+  struct IntLock   lock;
+  unsigned int     sigwait;
+  unsigned int     sigrecvd;
+};
+
+/* LightTask.code() return: run again after other work */
+#define LIGHTF_YIELD (1U << 31)
+
+/*
+ * Resume points in LightTask.code(), in the style of protothreads.
+ * Local variables are lost at LT_WAIT() and LT_YIELD(), so state
+ * is kept in the LightTask or work.data. LT_WAIT() and LT_YIELD()
+ * may not be used inside another switch statement.
+ */
+#define LT_BEGIN(lt) switch ((lt)->resume) { case 0:
+#define LT_WAIT(lt, sigmask) \
+  do { \
+    (lt)->resume = __LINE__; \
+    return (sigmask); \
+    case __LINE__:; \
+  } while (0)
+#define LT_YIELD(lt) LT_WAIT(lt, LIGHTF_YIELD)
+#define LT_END(lt) } (lt)->resume = 0; return 0
+
+/* Work items of one CPU and the task which runs them */
+struct WorkQueue {
+  struct List      list;
+  struct IntLock   lock;
+  struct Task     *task;
+  /* compared by CancelWork(), never dereferenced */
+  struct Work     *running;
+  /* incremented when running is done */
+  volatile unsigned int done;
+  int              ncancel;
+};
+
+/* Number of WaitAddress() queues, power of two */
+#define EXEC_WAITHASH 16
+
+/* Tasks in WaitAddress() on addresses which hash to the queue */
+struct WaitQueue {
+  struct List      list;
+  struct IntLock   lock;
+};
+
 struct ExecCPU {
   struct Node      node;
   /* local access, prevents switch by Reschedule() etc in ISR */
@@ -39,6 +126,10 @@ struct ExecCPU {
   struct Task *volatile heir;
   /* read only. */
   struct Task     *idle;
+  /* local write. last RCU epoch this CPU passed a quiescent state */
+  volatile unsigned long rcuepoch;
+  /* local access. software interrupts queued by Cause() */
+  struct List      softint;
 };
 
 struct ExecBase {
@@ -47,29 +138,64 @@ struct ExecBase {
   struct List      memlist; /* MemHeader */
   struct Mutex     memlock;
   struct List      liblist; /* Library */
-  struct Mutex     liblock; /* liblist nodes, opencount, flags */
+  struct Mutex     liblock; /* liblist nodes */
   struct List      devlist; /* Device */
-  struct Mutex     devlock; /* devlist nodes, opencount, flags */
+  struct Mutex     devlock; /* devlist nodes */
+  /* opencount, flags of libraries and devices */
+  struct IntLock   openlock;
+  /* RCU grace period state and deferred operations */
+  struct IntLock   rculock;
+  volatile unsigned long rcuepoch;
+  struct RCUHead  *rcupending;
+  /* single processor RCU reader nesting */
+  int              rcunest;
+  int              rculevel;
+
+  /* Interrupt.node.type transitions of Cause() */
+  struct IntLock   softintlock;
+  /* single processor software interrupt queue */
+  struct List      softint;
+
+  /* WaitAddress() queues, indexed by address hash */
+  struct WaitQueue waithash[EXEC_WAITHASH];
 
   struct List      reslist; /* ResidentNode, read only */
   /* An array of lists containing interrupt server nodes. */
   struct IntList  *intserver;
+  /* serializes the interrupt controller mask, SMP */
+  struct IntLock   intmasklock;
 
   struct List      taskready;   /* Task */
   struct List      taskremoved; /* Task */
   struct List      taskwait;    /* Task */
   struct List      cpuonline;   /* ExecCPU */
   struct List      cpuoffline;  /* ExecCPU */
+  int              ncpu;        /* GetCPUCount() */
   /*
    * invariant for all task lists, all tasks on the lists,
    * cpuonline, cpuoffline.
    */
   struct IntLock   tasklock;
 
-  struct Task     *cleantask;
+  /* one WorkQueue per CPU */
+  struct WorkQueue *workq;
+  int              nworkq;
+  /* removed tasks and CallRCU() operations */
+  struct Work      cleanwork;
 
   /* minimum stack buffer size for CreateTask() */
   size_t           minstack;
+  /* Task and stack of ended CreateTask() tasks, for reuse */
+  struct IntLock   taskcachelock;
+  struct List      taskcache;   /* MemList */
+  int              ntaskcache;
+  /* last ReportTaskStats() */
+  unsigned long    statstamp;
+  /* LatencyStats, NULL until allocated, see latency.c */
+  struct IntLock   latencylock;
+  struct LatencyStats *latency;
+  struct LatencyIPI *latipi;    /* one per CPU */
+  int              nlatipi;
 
   /* for tasks which don't provide their own trapcode() */
   void (*trapcode)(
@@ -11,7 +11,11 @@ struct Segment;
 
 /*
  * Covered by ExecBase LibLock invariant:
- * - node, opencount, flags
+ * - node (list linkage, read by lookups under ObtainRCU())
+ * Covered by ExecBase OpenLock invariant:
+ * - opencount, flags
+ * opencount 0 with LIBF_DELEXP set means that the library is
+ * being removed and can not be opened.
  *
  * A user which has done OpenLibrary() has read-only access to:
  * - Anything not covered by the liblock invariant
@@ -26,6 +26,8 @@ struct Node {
 #define NT_MEMLIST    10
 #define NT_CPU        11
 #define NT_PROCESS    12
+#define NT_SOFTINT    13 /* Interrupt is queued by Cause() */
+#define NT_WORK       14 /* Work is queued by QueueWork() */
 #define NT_CUSTOM     64
 
 struct List {
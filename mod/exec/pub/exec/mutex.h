@@ -8,18 +8,93 @@
 
 typedef unsigned int AtomicInteger;
 
+struct ExecBase;
+
 struct IntLock {
   AtomicInteger  next_ticket;
   AtomicInteger  now_serving;
   int            plevel; /* local interrupt level */
 };
 
+/* Size of the per-CPU reader state in a BRLock */
+#define BRLOCK_SLOTSIZE 64
+
+struct BRLockSlot {
+  volatile int   readers;
+  char           pad[BRLOCK_SLOTSIZE - sizeof (int)];
+};
+
+/*
+ * A BRLock (big-reader lock) is a reader-writer IntLock. Readers
+ * only update the reader state of the local CPU, which is kept on
+ * a separate cache line, so readers on different CPUs do not
+ * serialize. Writers are serialized by writer and have to wait for
+ * the readers on all CPUs.
+ */
+struct BRLock {
+  /* CPU id + 1 of the writer, or 0. Holder count on one CPU. */
+  volatile AtomicInteger writer;
+  int                plevel; /* local interrupt level of writer */
+  int                ncpu;
+  struct BRLockSlot *slot; /* ncpu elements, indexed by CPU id */
+};
+
+/* Operation deferred until after an RCU grace period */
+struct RCUHead {
+  struct RCUHead  *next;
+  void           (*func)(struct ExecBase *lib, struct RCUHead *head);
+};
+
+/*
+ * A Mutex is either free, owned exclusively by one task (owner)
+ * or owned in shared mode by one or more tasks (shared).
+ */
 struct Mutex {
   struct List      waitqueue;
   struct Task     *owner;
   struct IntLock   lock;
   int              nest;
+  int              shared; /* number of shared owners */
+};
+
+/* Counting semaphore */
+struct Semaphore {
+  struct List      waitqueue;
+  struct IntLock   lock;
+  int              count;
 };
 
+/* Condition variable, used together with a Mutex */
+struct Condition {
+  struct List      waitqueue;
+  struct IntLock   lock;
+};
+
+/* Group of event flags */
+struct EventFlags {
+  struct List      waitqueue;
+  struct IntLock   lock;
+  unsigned int     flags;
+};
+
+/*
+ * Sense-reversing barrier for a fixed number of tasks. The last
+ * task to arrive flips sense, which releases the others.
+ */
+struct Barrier {
+  volatile AtomicInteger count;    /* arrived in current round */
+  volatile AtomicInteger sense;    /* flipped by each round */
+  volatile AtomicInteger sleepers; /* in WaitAddress() on sense */
+  int              n;
+  int              spin;     /* polls of sense before sleeping */
+};
+
+/* Default Barrier.spin on multiprocessor systems */
+#define BARRIER_SPIN 1000
+
+/* WaitEventFlags() mode */
+#define EVF_ALL      (1U << 0) /* wait for all flags, else any */
+#define EVF_CLEAR    (1U << 1) /* clear the flags waited for */
+
 #endif
 
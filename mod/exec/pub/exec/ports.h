@@ -9,7 +9,13 @@
 #include <exec/mutex.h>
 
 struct Task;
+struct LightTask;
 
+/*
+ * With MPF_LOCKFREE, senders push messages on the pending stack
+ * with an atomic operation and inv.lock is not used. The port
+ * owner moves them to msglist, which only the owner accesses.
+ */
 struct MsgPort {
   struct {
     struct IntLock   lock;
@@ -17,9 +23,20 @@ struct MsgPort {
   } inv;
   /* NOTE: no arbitration on SigBit and SigTask */
   struct Task     *sigtask;
+  /* signalled instead if sigtask is NULL */
+  struct LightTask *siglight;
   signed char      sigbit;
+  unsigned char    flags;
+  void *volatile   pending; /* MPF_LOCKFREE: LIFO of Message.node */
+  /* receiver in WaitMsg(), signal for every message */
+  volatile AtomicInteger waiting;
+  /* statistics: messages added without signaling sigtask */
+  volatile AtomicInteger suppressed;
 };
 
+/* MsgPort.flags */
+#define MPF_LOCKFREE (1U << 0) /* multi-producer, single consumer */
+
 struct Message {
   /*
    * Part of MsgPort->msglist invariant:
@@ -32,5 +49,33 @@ struct Message {
   size_t           length;
 };
 
+/* Ring indexes are on separate cache lines of this size */
+#define RING_LINESIZE 64
+
+/* State written by one side of a Ring */
+struct RingIndex {
+  volatile AtomicInteger pos;     /* published position */
+  volatile AtomicInteger waiting; /* side is about to sleep */
+  unsigned int     pending; /* reserved or read, not published */
+  char             pad[RING_LINESIZE - 3 * sizeof (AtomicInteger)];
+};
+
+/*
+ * Single-producer single-consumer channel of fixed size records.
+ * Positions are free running and the record at position p is at
+ * buf + (p & mask) * recsize.
+ */
+struct Ring {
+  struct RingIndex prod;    /* written by the producer */
+  struct RingIndex cons;    /* written by the consumer */
+  char            *buf;
+  unsigned int     mask;    /* number of records - 1 */
+  size_t           recsize;
+  struct Task     *sigtask; /* consumer */
+  signed char      sigbit;
+  void            *mem;     /* allocation */
+  size_t           memsize;
+};
+
 #endif
 
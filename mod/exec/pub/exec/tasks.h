@@ -13,6 +13,35 @@ struct StackCanaries {
   int num;
 };
 
+/* GetTaskStats(), times in GetTimeStamp() counts */
+struct TaskStats {
+  unsigned long long runtime;      /* running on a CPU */
+  unsigned long long readytime;    /* ready, waiting for a CPU */
+  unsigned long    nswitch;        /* switched in */
+  unsigned long    nvoluntary;     /* switched out to wait or end */
+  unsigned long    ninvoluntary;   /* switched out while ready */
+};
+
+/* GetLatency() */
+#define LAT_WAKEUP   0 /* from wakeup to running, per priority */
+#define LAT_IPI      1 /* from sending to receiving a scheduler IPI */
+#define LAT_NBUCKET  32
+#define LAT_NAMELEN  12
+
+/* Times in GetTimeStamp() counts */
+struct LatencyStats {
+  int              pri;            /* of the woken tasks */
+  unsigned long    n;
+  /* bucket[i] counts 2^i <= t < 2^(i+1), the ends are open */
+  unsigned long    bucket[LAT_NBUCKET];
+  unsigned long    max;
+  /* worst case: task woken by waker on maxcpu, which ran prev */
+  unsigned int     maxcpu;
+  char             maxtask[LAT_NAMELEN];
+  char             maxwaker[LAT_NAMELEN];
+  char             maxprev[LAT_NAMELEN];
+};
+
 struct Task {
   struct Node      node;
   struct TaskArch *arch;
@@ -43,6 +72,49 @@ struct Task {
     void *trapinfo
   );
   void            *user;
+  /* running Coroutine, NULL for the task itself */
+  struct Coroutine *coroutine;
+  /*
+   * private: exec.library is built with or without these, so other
+   * modules shall not depend on them or on sizeof (struct Task).
+   */
+#if defined (CFG_TASKSTATS) && CFG_TASKSTATS
+  /*
+   * Updated by the CPU the task switches on, read with
+   * GetTaskStats(). statseq is odd while they are written.
+   */
+  struct TaskStats stats;
+  unsigned long    statstamp;  /* last switch */
+  char             statrunning;
+  volatile unsigned int statseq;
+  /* set by wakeup() */
+  unsigned long    readystamp;
+  /* runtime at the last ReportTaskStats() */
+  unsigned long long statreported;
+#endif
+#if defined (CFG_LATENCY) && CFG_LATENCY
+  /* set by wakeup() for LatencyStats */
+  unsigned long    wakestamp;
+  struct Task     *waker;
+#endif
+};
+
+/*
+ * Flow of control with its own stack inside a task, see
+ * CreateCoroutine(). The caller may set node.name and user.
+ */
+struct Coroutine {
+  struct Node      node;
+  void           (*code)(struct ExecBase *lib, struct Coroutine *co);
+  void            *user;
+  /* signals which ended AwaitCoroutine() */
+  unsigned int     signals;
+  /* private */
+  unsigned int     sigwait;
+  void            *sp;      /* context while not running */
+  void            *caller;  /* context of ResumeCoroutine() */
+  size_t           memsize;
+  char             state;
 };
 
 /* Task.state */
@@ -58,9 +130,9 @@ struct Task {
 
 /* Reserved signal numbers and bits for Signal() and Wait() */
 #define SIGB_SINGLE  0
-#define SIGB_CLEANUP 1
+#define SIGB_WORK    1
 #define SIGF_SINGLE  (1U << SIGB_SINGLE)
-#define SIGF_CLEANUP (1U << SIGB_CLEANUP)
+#define SIGF_WORK    (1U << SIGB_WORK)
 
 #endif
 
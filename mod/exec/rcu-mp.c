@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Read-copy-update, SMP version */
+
+#include <priv.h>
+#include <port.h>
+
+/*
+ * A reader disables task switches on the local CPU. So when a
+ * CPU enters switch_tasks() it is not in a read-side section:
+ * that is a quiescent state, and the CPU records the current
+ * lib->rcuepoch in cpu->rcuepoch.
+ *
+ * SyncRCU() starts a new epoch and waits for all online CPUs to
+ * record it. CPUs which do not switch tasks by themselves, for
+ * example idle ones, get an IPI which makes them enter
+ * switch_tasks() as soon as they are outside any section.
+ */
+
+void iObtainRCU(Lib *lib) {
+  int level;
+
+  level = port_disable_interrupts();
+  port_get_cpu()->switch_disable++;
+  port_enable_interrupts(level);
+}
+
+void iReleaseRCU(Lib *lib) {
+  ExecCPU *cpu;
+  int level;
+
+  level = port_disable_interrupts();
+  cpu = port_get_cpu();
+  switch_enable(lib, cpu, level);
+  port_enable_interrupts(level);
+}
+
+static int passed(unsigned long seen, unsigned long epoch) {
+  return (long) (seen - epoch) >= 0;
+}
+
+/*
+ * Return an online CPU which has not passed epoch, or NULL. The
+ * local CPU is in a quiescent state since we are running here.
+ */
+static ExecCPU *behind(Lib *lib, unsigned long epoch, int kick) {
+  ExecCPU *ret;
+  ExecCPU *self;
+  const List *list;
+
+  ret = NULL;
+  list = &lib->cpuonline;
+  lObtainIntLock(lib, &lib->tasklock);
+  self = port_get_cpu();
+  KASSERT(self->switch_disable == 0);
+  for (Node *node = list->head; node->succ; node = node->succ) {
+    ExecCPU *cpu;
+
+    cpu = (ExecCPU *) node;
+    if (passed(cpu->rcuepoch, epoch)) {
+      continue;
+    }
+    if (cpu == self) {
+      cpu->rcuepoch = epoch;
+      continue;
+    }
+    if (ret == NULL) {
+      ret = cpu;
+    }
+    if (kick == 0) {
+      break;
+    }
+    port_send_ipi(cpu->id);
+  }
+  lReleaseIntLock(lib, &lib->tasklock);
+  return ret;
+}
+
+void iSyncRCU(Lib *lib) {
+  unsigned long epoch;
+  ExecCPU *cpu;
+  int kick;
+
+  lObtainIntLock(lib, &lib->rculock);
+  epoch = ++lib->rcuepoch;
+  lReleaseIntLock(lib, &lib->rculock);
+  /* Order the removals before the new epoch is observed. */
+  port_memory_barrier();
+
+  kick = 1;
+  /* ExecCPU structures are never deallocated. */
+  while ((cpu = behind(lib, epoch, kick))) {
+    kick = 0;
+    while (!passed(cpu->rcuepoch, epoch)) {
+      ;
+    }
+  }
+  port_memory_barrier();
+}
+
@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Read-copy-update, single processor version */
+
+#include <priv.h>
+#include <port.h>
+
+/*
+ * Readers disable interrupts, so no reader can be active when a
+ * writer executes and a grace period has always passed.
+ */
+
+void iObtainRCU(Lib *lib) {
+  int level;
+
+  level = port_disable_interrupts();
+  if (lib->rcunest == 0) {
+    lib->rculevel = level;
+  }
+  lib->rcunest++;
+}
+
+void iReleaseRCU(Lib *lib) {
+  lib->rcunest--;
+  if (lib->rcunest == 0) {
+    port_enable_interrupts(lib->rculevel);
+  }
+}
+
+void iSyncRCU(Lib *lib) {
+  KASSERT(lib->rcunest == 0);
+}
+
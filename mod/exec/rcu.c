@@ -0,0 +1,69 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Read-copy-update, common part */
+
+#include <priv.h>
+#include <port.h>
+
+/*
+ * Same as Enqueue() but the node is completely linked before it
+ * becomes reachable from the list head, so readers traversing
+ * succ pointers under ObtainRCU() see either the old or the new
+ * list.
+ */
+void enqueue_rcu(Lib *lib, List *list, Node *node) {
+  Node *nextnode;
+
+  nextnode = list->head;
+  while (NULL != nextnode->succ) {
+    if (nextnode->pri < node->pri) {
+      break;
+    }
+    nextnode = nextnode->succ;
+  }
+  node->succ = nextnode;
+  node->pred = nextnode->pred;
+  port_memory_barrier();
+  nextnode->pred->succ = node;
+  nextnode->pred = node;
+}
+
+void iCallRCU(
+  Lib *lib,
+  struct RCUHead *head,
+  void (*func)(Lib *lib, struct RCUHead *head)
+) {
+  head->func = func;
+  lObtainIntLock(lib, &lib->rculock);
+  head->next = lib->rcupending;
+  lib->rcupending = head;
+  lReleaseIntLock(lib, &lib->rculock);
+  /* Before the work queues exist, the next cleanup does it. */
+  if (lib->workq) {
+    lQueueWork(lib, &lib->cleanwork, WORK_ANYCPU);
+  }
+}
+
+/* called by the cleanup task */
+void runrcu(Lib *lib) {
+  struct RCUHead *head;
+
+  lObtainIntLock(lib, &lib->rculock);
+  head = lib->rcupending;
+  lib->rcupending = NULL;
+  lReleaseIntLock(lib, &lib->rculock);
+  if (head == NULL) {
+    return;
+  }
+
+  lSyncRCU(lib);
+  while (head) {
+    struct RCUHead *next;
+
+    next = head->next;
+    head->func(lib, head);
+    head = next;
+  }
+}
+
@@ -0,0 +1,169 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Single-producer single-consumer ring channel */
+
+#include <stdint.h>
+#include <priv.h>
+#include <exec/atomic.h>
+
+/*
+ * Each side publishes its position with a release barrier and
+ * reads the other position followed by an acquire barrier, so the
+ * records themselves are never locked.
+ *
+ * Before a side sleeps it sets its waiting flag and checks the
+ * other position again. The other side publishes its position and
+ * then checks the flag. Both do a full barrier in between, so a
+ * wakeup is not lost. A side only wakes the other when it waits,
+ * which is at most once per batch.
+ *
+ * The consumer waits on the ring signal, which it owns. The
+ * producer waits with WaitAddress() on the consumer position so
+ * that no signal bit of the producer is used.
+ */
+
+Ring *iCreateRing(Lib *lib, unsigned int nrec, size_t recsize) {
+  Ring *ring;
+  void *mem;
+  size_t memsize;
+  unsigned int n;
+  int sigbit;
+
+  if (nrec == 0 || recsize == 0) {
+    return NULL;
+  }
+  n = 1;
+  while (n < nrec) {
+    n <<= 1;
+    if (n == 0) {
+      return NULL;
+    }
+  }
+  recsize = (recsize + sizeof (long) - 1) & ~(sizeof (long) - 1);
+  memsize = RING_LINESIZE - 1 + sizeof *ring + n * recsize;
+
+  mem = lAllocMem(lib, memsize, MEMF_CLEAR | MEMF_ANY);
+  if (mem == NULL) {
+    return NULL;
+  }
+  sigbit = lAllocSignal(lib, -1);
+  if (sigbit < 0) {
+    lFreeMem(lib, mem, memsize);
+    return NULL;
+  }
+
+  ring = (Ring *) (
+    ((uintptr_t) mem + (RING_LINESIZE - 1)) &
+    ~(uintptr_t) (RING_LINESIZE - 1)
+  );
+  ring->sigtask = lFindTask(lib);
+  ring->buf = (char *) (ring + 1);
+  ring->mask = n - 1;
+  ring->recsize = recsize;
+  ring->sigbit = sigbit;
+  ring->mem = mem;
+  ring->memsize = memsize;
+  return ring;
+}
+
+void iDeleteRing(Lib *lib, Ring *ring) {
+  if (ring == NULL) {
+    return;
+  }
+  lFreeSignal(lib, ring->sigbit);
+  lFreeMem(lib, ring->mem, ring->memsize);
+}
+
+static void *slot(Ring *ring, unsigned int pos) {
+  return ring->buf + (pos & ring->mask) * ring->recsize;
+}
+
+void *iReserveRing(Lib *lib, Ring *ring) {
+  unsigned int pos;
+
+  pos = ring->prod.pos + ring->prod.pending;
+  if (pos - ring->cons.pos > ring->mask) {
+    return NULL;
+  }
+  /* The consumer is done with the slot. */
+  atomic_acquire(lib);
+  ring->prod.pending++;
+  return slot(ring, pos);
+}
+
+void iCommitRing(Lib *lib, Ring *ring) {
+  if (ring->prod.pending == 0) {
+    return;
+  }
+  atomic_release(lib);
+  ring->prod.pos += ring->prod.pending;
+  ring->prod.pending = 0;
+  atomic_fence(lib);
+  if (ring->cons.waiting) {
+    lSignal(lib, ring->sigtask, 1U << ring->sigbit);
+  }
+}
+
+void *iReadRing(Lib *lib, Ring *ring) {
+  unsigned int pos;
+
+  pos = ring->cons.pos + ring->cons.pending;
+  if (pos == ring->prod.pos) {
+    return NULL;
+  }
+  atomic_acquire(lib);
+  ring->cons.pending++;
+  return slot(ring, pos);
+}
+
+void iReleaseRing(Lib *lib, Ring *ring) {
+  if (ring->cons.pending == 0) {
+    return;
+  }
+  /* Reads of the records are done before the slots are reused. */
+  atomic_release(lib);
+  ring->cons.pos += ring->cons.pending;
+  ring->cons.pending = 0;
+  atomic_fence(lib);
+  if (ring->prod.waiting) {
+    lWakeAddress(lib, &ring->cons.pos, 1);
+  }
+}
+
+static int hasdata(Ring *ring) {
+  return ring->cons.pos + ring->cons.pending != ring->prod.pos;
+}
+
+static int hasspace(Ring *ring) {
+  unsigned int pos;
+
+  pos = ring->prod.pos + ring->prod.pending;
+  return pos - ring->cons.pos <= ring->mask;
+}
+
+void iWaitRing(Lib *lib, Ring *ring) {
+  while (!hasdata(ring)) {
+    atomic_swap(lib, &ring->cons.waiting, 1);
+    if (!hasdata(ring)) {
+      lWait(lib, 1U << ring->sigbit);
+    }
+    ring->cons.waiting = 0;
+  }
+  atomic_acquire(lib);
+}
+
+void iWaitRingSpace(Lib *lib, Ring *ring) {
+  unsigned int pos;
+
+  while (!hasspace(ring)) {
+    pos = ring->cons.pos;
+    atomic_swap(lib, &ring->prod.waiting, 1);
+    if (!hasspace(ring)) {
+      lWaitAddress(lib, &ring->cons.pos, pos);
+    }
+    ring->prod.waiting = 0;
+  }
+  atomic_acquire(lib);
+}
+
@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Software interrupts, SMP version */
+
+#include <priv.h>
+#include <port.h>
+
+/*
+ * Each CPU has its own queue which is only accessed by the CPU
+ * itself with interrupts disabled. The queue is drained when the
+ * outermost interrupt exits, on the interrupt stack, before any
+ * task switch. A task which calls Cause() sends an IPI to its own
+ * CPU to get there.
+ *
+ * An Interrupt can be queued on one CPU at a time. softintlock
+ * makes the NT_SOFTINT claim atomic between CPUs. Since the queue
+ * itself is CPU local, an empty queue is detected without the
+ * lock.
+ */
+
+void iCause(Lib *lib, Interrupt *is) {
+  ExecCPU *cpu;
+
+  lObtainIntLock(lib, &lib->softintlock);
+  if (is->node.type == NT_SOFTINT) {
+    lReleaseIntLock(lib, &lib->softintlock);
+    return;
+  }
+  is->node.type = NT_SOFTINT;
+  cpu = port_get_cpu();
+  iEnqueue(lib, &cpu->softint, &is->node);
+  if (cpu->isr_nest == 0) {
+    port_send_ipi(cpu->id);
+  }
+  lReleaseIntLock(lib, &lib->softintlock);
+}
+
+/*
+ * Called by the port at interrupt exit with interrupts disabled,
+ * isr_nest and switch_disable not yet decremented.
+ */
+void runsoftints(Lib *lib) {
+  ExecCPU *cpu;
+  Interrupt *is;
+
+  cpu = port_get_cpu();
+  if (cpu->isr_nest != 1) {
+    return;
+  }
+  while (cpu->softint.head->succ) {
+    lObtainIntLock(lib, &lib->softintlock);
+    is = (Interrupt *) iRemHead(lib, &cpu->softint);
+    is->node.type = NT_INTERRUPT;
+    lReleaseIntLock(lib, &lib->softintlock);
+    port_really_enable_interrupts();
+    is->code(lib, is->data);
+    port_disable_interrupts();
+  }
+}
+
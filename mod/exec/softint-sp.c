@@ -0,0 +1,40 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Software interrupts, single processor version */
+
+#include <priv.h>
+#include <port.h>
+
+/*
+ * The queue is protected by disabling interrupts. The port calls
+ * runsoftints() when no interrupt handler is active, for example
+ * from the lowest priority exception.
+ */
+
+void iCause(Lib *lib, Interrupt *is) {
+  int level;
+
+  level = port_disable_interrupts();
+  if (is->node.type != NT_SOFTINT) {
+    is->node.type = NT_SOFTINT;
+    iEnqueue(lib, &lib->softint, &is->node);
+    port_raise_softint();
+  }
+  port_enable_interrupts(level);
+}
+
+void runsoftints(Lib *lib) {
+  Interrupt *is;
+  int level;
+
+  level = port_disable_interrupts();
+  while ((is = (Interrupt *) iRemHead(lib, &lib->softint))) {
+    is->node.type = NT_INTERRUPT;
+    port_enable_interrupts(level);
+    is->code(lib, is->data);
+    level = port_disable_interrupts();
+  }
+  port_enable_interrupts(level);
+}
+
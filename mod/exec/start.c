@@ -38,13 +38,25 @@ void initlib(Lib *lib) {
   iNewList(lib, &lib->reslist);
   iNewList(lib, &lib->cpuonline);
   iNewList(lib, &lib->cpuoffline);
+  lib->ncpu = port_get_ncpu(lib);
   iNewList(lib, &lib->taskready);
   iNewList(lib, &lib->taskremoved);
   iNewList(lib, &lib->taskwait);
+  iNewList(lib, &lib->taskcache);
+  iNewList(lib, &lib->softint);
   iInitMutex(lib, &lib->memlock);
   iInitMutex(lib, &lib->liblock);
   iInitMutex(lib, &lib->devlock);
+  iInitIntLock(lib, &lib->openlock);
+  iInitIntLock(lib, &lib->rculock);
+  iInitIntLock(lib, &lib->softintlock);
   iInitIntLock(lib, &lib->tasklock);
+  iInitIntLock(lib, &lib->taskcachelock);
+  iInitIntLock(lib, &lib->latencylock);
+  for (size_t i = 0; i < NELEM(lib->waithash); i++) {
+    iNewList(lib, &lib->waithash[i].list);
+    iInitIntLock(lib, &lib->waithash[i].lock);
+  }
   iAddLibrary(lib, &lib->lib);
 }
 
@@ -60,6 +72,14 @@ Segment *iExpungeBase(Library *lib) {
   return NULL;
 }
 
+unsigned long iGetTimeStamp(Lib *lib) {
+  return port_get_timestamp();
+}
+
+int iGetCPUCount(Lib *lib) {
+  return lib->ncpu;
+}
+
 void kprintf(Lib *lib, const char *fmt, ...) {
   va_list ap;
   va_start(ap, fmt);
@@ -0,0 +1,370 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/*
+ * Counting semaphores, condition variables, event flags, address
+ * wait queues and barriers
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <priv.h>
+#include <port.h>
+#include <exec/atomic.h>
+
+/*
+ * The waiting tasks are queued as Waiter nodes, in FIFO order,
+ * and Wait() on SIGF_SINGLE. Waking moves the Waiter nodes to a
+ * local list under the IntLock. The tasks are then signaled with
+ * wakeall() which does a single scheduling pass, also when many
+ * tasks are woken.
+ */
+
+/* Move up to n Waiters from queue to wake. Return number moved. */
+static int takewaiters(Lib *lib, List *queue, List *wake, int n) {
+  Node *node;
+  int i;
+
+  for (i = 0; i < n; i++) {
+    node = iRemHead(lib, queue);
+    if (node == NULL) {
+      break;
+    }
+    iAddTail(lib, wake, node);
+  }
+  return i;
+}
+
+void iInitSemaphore(Lib *lib, Semaphore *sem, int count) {
+  iNewList(lib, &sem->waitqueue);
+  lInitIntLock(lib, &sem->lock);
+  sem->count = count;
+}
+
+/* Must be called with sem->lock held. */
+static int trysemaphore(Lib *lib, Semaphore *sem) {
+  if (sem->count == 0) {
+    return 0;
+  }
+  KASSERT(iGetHead(lib, &sem->waitqueue) == NULL);
+  sem->count--;
+  return 1;
+}
+
+void iObtainSemaphore(Lib *lib, Semaphore *sem) {
+  Waiter waiter;
+
+  if (lAttemptSemaphore(lib, sem)) {
+    return;
+  }
+
+  waiter.task = port_ThisTask(lib);
+  lClearSignal(lib, SIGF_SINGLE);
+
+  lObtainIntLock(lib, &sem->lock);
+  if (trysemaphore(lib, sem)) {
+    lReleaseIntLock(lib, &sem->lock);
+    return;
+  }
+  iAddTail(lib, &sem->waitqueue, &waiter.node);
+  lReleaseIntLock(lib, &sem->lock);
+
+  /* ReleaseSemaphore() has transferred one count to us. */
+  lWait(lib, SIGF_SINGLE);
+}
+
+int iAttemptSemaphore(Lib *lib, Semaphore *sem) {
+  int ret;
+
+  lObtainIntLock(lib, &sem->lock);
+  ret = trysemaphore(lib, sem);
+  lReleaseIntLock(lib, &sem->lock);
+  return ret;
+}
+
+void iReleaseSemaphore(Lib *lib, Semaphore *sem, int count) {
+  List wake;
+
+  KASSERT(0 <= count);
+  iNewList(lib, &wake);
+  lObtainIntLock(lib, &sem->lock);
+  /* Hand over counts directly to the waiters. */
+  count -= takewaiters(lib, &sem->waitqueue, &wake, count);
+  sem->count += count;
+  lReleaseIntLock(lib, &sem->lock);
+
+  wakeall(lib, &wake);
+}
+
+void iInitCondition(Lib *lib, Condition *cond) {
+  iNewList(lib, &cond->waitqueue);
+  lInitIntLock(lib, &cond->lock);
+}
+
+void iWaitCondition(Lib *lib, Condition *cond, Mutex *mutex) {
+  Waiter waiter;
+
+  waiter.task = port_ThisTask(lib);
+  KASSERT(mutex->owner == waiter.task);
+  KASSERT(mutex->nest == 0);
+  lClearSignal(lib, SIGF_SINGLE);
+
+  /* Queued before the Mutex is released so no wakeup is lost. */
+  lObtainIntLock(lib, &cond->lock);
+  iAddTail(lib, &cond->waitqueue, &waiter.node);
+  lReleaseIntLock(lib, &cond->lock);
+
+  lReleaseMutex(lib, mutex);
+  lWait(lib, SIGF_SINGLE);
+  lObtainMutex(lib, mutex);
+}
+
+static void wakecondition(Lib *lib, Condition *cond, int n) {
+  List wake;
+
+  iNewList(lib, &wake);
+  lObtainIntLock(lib, &cond->lock);
+  takewaiters(lib, &cond->waitqueue, &wake, n);
+  lReleaseIntLock(lib, &cond->lock);
+
+  wakeall(lib, &wake);
+}
+
+void iSignalCondition(Lib *lib, Condition *cond) {
+  wakecondition(lib, cond, 1);
+}
+
+void iBroadcastCondition(Lib *lib, Condition *cond) {
+  wakecondition(lib, cond, INT_MAX);
+}
+
+void iInitEventFlags(Lib *lib, EventFlags *ev, unsigned int flags) {
+  iNewList(lib, &ev->waitqueue);
+  lInitIntLock(lib, &ev->lock);
+  ev->flags = flags;
+}
+
+/*
+ * Satisfy a wait for mask if possible. Must be called with
+ * ev->lock held.
+ *
+ * return: 1 if satisfied and *result is set, else 0
+ */
+static int tryflags(
+  EventFlags *ev,
+  unsigned int mask,
+  int mode,
+  unsigned int *result
+) {
+  unsigned int match;
+
+  match = ev->flags & mask;
+  if (mode & EVF_ALL) {
+    if (match != mask) {
+      return 0;
+    }
+  } else if (match == 0) {
+    return 0;
+  }
+  *result = ev->flags;
+  if (mode & EVF_CLEAR) {
+    ev->flags &= ~mask;
+  }
+  return 1;
+}
+
+unsigned int iWaitEventFlags(
+  Lib *lib,
+  EventFlags *ev,
+  unsigned int mask,
+  int mode
+) {
+  Waiter waiter;
+  unsigned int result;
+  int gotit;
+
+  KASSERT(mask);
+  lObtainIntLock(lib, &ev->lock);
+  gotit = tryflags(ev, mask, mode, &result);
+  lReleaseIntLock(lib, &ev->lock);
+
+  if (gotit) {
+    return result;
+  }
+
+  waiter.task = port_ThisTask(lib);
+  waiter.mask = mask;
+  waiter.mode = mode;
+  lClearSignal(lib, SIGF_SINGLE);
+
+  lObtainIntLock(lib, &ev->lock);
+  gotit = tryflags(ev, mask, mode, &result);
+  if (!gotit) {
+    iAddTail(lib, &ev->waitqueue, &waiter.node);
+  }
+  lReleaseIntLock(lib, &ev->lock);
+
+  if (gotit) {
+    return result;
+  }
+
+  /* SetEventFlags() has set waiter.result for us. */
+  lWait(lib, SIGF_SINGLE);
+  return waiter.result;
+}
+
+unsigned int iSetEventFlags(
+  Lib *lib,
+  EventFlags *ev,
+  unsigned int mask
+) {
+  List wake;
+  Node *node;
+  Node *succ;
+  unsigned int old;
+
+  iNewList(lib, &wake);
+  lObtainIntLock(lib, &ev->lock);
+  old = ev->flags;
+  ev->flags |= mask;
+  /* Waiters are served in FIFO order, also for EVF_CLEAR. */
+  for (node = ev->waitqueue.head; node->succ; node = succ) {
+    Waiter *waiter;
+
+    succ = node->succ;
+    waiter = (Waiter *) node;
+    if (tryflags(ev, waiter->mask, waiter->mode, &waiter->result)) {
+      iRemove(lib, node);
+      iAddTail(lib, &wake, node);
+    }
+  }
+  lReleaseIntLock(lib, &ev->lock);
+
+  wakeall(lib, &wake);
+  return old;
+}
+
+unsigned int iClearEventFlags(
+  Lib *lib,
+  EventFlags *ev,
+  unsigned int mask
+) {
+  unsigned int old;
+
+  lObtainIntLock(lib, &ev->lock);
+  old = ev->flags;
+  ev->flags &= ~mask;
+  lReleaseIntLock(lib, &ev->lock);
+  return old;
+}
+
+static WaitQueue *waitqueue(Lib *lib, volatile unsigned int *addr) {
+  uintptr_t h;
+
+  h = (uintptr_t) addr / sizeof *addr;
+  h ^= h >> 4;
+  h ^= h >> 8;
+  return &lib->waithash[h & (EXEC_WAITHASH - 1)];
+}
+
+/*
+ * The value is compared under the queue lock and WakeAddress()
+ * takes the same lock. So a waker which stores a new value before
+ * calling WakeAddress() either makes the comparison fail or finds
+ * the Waiter on the queue.
+ */
+int iWaitAddress(
+  Lib *lib,
+  volatile unsigned int *addr,
+  unsigned int expected
+) {
+  WaitQueue *wq;
+  Waiter waiter;
+
+  wq = waitqueue(lib, addr);
+  waiter.task = port_ThisTask(lib);
+  waiter.addr = addr;
+  lClearSignal(lib, SIGF_SINGLE);
+
+  lObtainIntLock(lib, &wq->lock);
+  if (*addr != expected) {
+    lReleaseIntLock(lib, &wq->lock);
+    return 0;
+  }
+  iAddTail(lib, &wq->list, &waiter.node);
+  lReleaseIntLock(lib, &wq->lock);
+
+  lWait(lib, SIGF_SINGLE);
+  return 1;
+}
+
+int iWakeAddress(Lib *lib, volatile unsigned int *addr, int n) {
+  WaitQueue *wq;
+  List wake;
+  Node *node;
+  Node *succ;
+  int num;
+
+  wq = waitqueue(lib, addr);
+  iNewList(lib, &wake);
+  num = 0;
+  lObtainIntLock(lib, &wq->lock);
+  for (node = wq->list.head; node->succ && num < n; node = succ) {
+    succ = node->succ;
+    if (((Waiter *) node)->addr != addr) {
+      continue;
+    }
+    iRemove(lib, node);
+    iAddTail(lib, &wake, node);
+    num++;
+  }
+  lReleaseIntLock(lib, &wq->lock);
+
+  wakeall(lib, &wake);
+  return num;
+}
+
+void iInitBarrier(Lib *lib, Barrier *bar, int n) {
+  KASSERT(0 < n);
+  bar->count = 0;
+  bar->sense = 0;
+  bar->sleepers = 0;
+  bar->n = n;
+  /* Spinning can only help if the others run on other CPUs. */
+  bar->spin = 1 < port_get_ncpu(lib) ? BARRIER_SPIN : 0;
+}
+
+/*
+ * A task which decides to sleep increments sleepers before it
+ * checks sense in WaitAddress(). The last task flips sense before
+ * it reads sleepers. Both are full barriers so at least one of
+ * them sees the other and WakeAddress() is only called when
+ * someone may sleep.
+ */
+int iWaitBarrier(Lib *lib, Barrier *bar) {
+  unsigned int sense;
+
+  sense = bar->sense;
+  if (atomic_add(lib, &bar->count, 1) == (unsigned int) bar->n - 1) {
+    bar->count = 0;
+    atomic_swap(lib, &bar->sense, !sense);
+    if (bar->sleepers) {
+      lWakeAddress(lib, &bar->sense, INT_MAX);
+    }
+    return 1;
+  }
+
+  for (int i = 0; i < bar->spin; i++) {
+    if (bar->sense != sense) {
+      atomic_acquire(lib);
+      return 0;
+    }
+  }
+  atomic_add(lib, &bar->sleepers, 1);
+  while (bar->sense == sense) {
+    lWaitAddress(lib, &bar->sense, sense);
+  }
+  atomic_add(lib, &bar->sleepers, -1);
+  return 0;
+}
+
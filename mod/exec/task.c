@@ -31,9 +31,37 @@ void check_canaries(Lib *lib, StackCanaries *can) {
   }
 }
 
+#define STACK_PAINT 0xa5a5a5a5U
+
+/* Fill the unused stack between the canaries and the context. */
+static void paintstack(Task *task) {
+  unsigned int *p;
+
+  p = task->splower;
+  while (p < (unsigned int *) task->arch) {
+    *p++ = STACK_PAINT;
+  }
+}
+
+size_t iGetStackUsage(Lib *lib, Task *task) {
+  const unsigned int *p;
+
+  if (!CFG_STACKPAINT) {
+    return 0;
+  }
+  p = task->splower;
+  while (p < (unsigned int *) task->spupper && *p == STACK_PAINT) {
+    p++;
+  }
+  return (char *) task->spupper - (char *) p;
+}
+
 Task *iAddTask(Lib *lib, Task *task) {
   port_prepstack(lib, task);
   task->splower = set_canaries(&task->canaries, task->splower);
+  if (CFG_STACKPAINT) {
+    paintstack(task);
+  }
 
   dbg("AddTask() %-8s @ %p", task->node.name, (void *) task);
   dbg(" arch @ %p [%p..%p]\n", task->arch, task->splower,
@@ -44,6 +72,18 @@ Task *iAddTask(Lib *lib, Task *task) {
   task->sigalloc = SIGF_SINGLE;
   task->sigwait  = 0;
   task->sigrecvd = 0;
+  task->coroutine = NULL;
+#if CFG_TASKSTATS
+  task->stats = (TaskStats) { 0 };
+  task->statstamp = port_get_timestamp();
+  task->statrunning = 0;
+  task->statseq = 0;
+  task->readystamp = task->statstamp;
+  task->statreported = 0;
+#endif
+#if CFG_LATENCY
+  task->waker = NULL;
+#endif
   if (task->trapcode == NULL) {
     task->trapcode = lib->trapcode;
   }
@@ -158,7 +198,16 @@ unsigned int iClearSignal(Lib *lib, unsigned int sigmask) {
   return old;
 }
 
-void iSignal(Lib *lib, Task *task, unsigned int sigmask) {
+/*
+ * Post sigmask to task and make it ready if it waits for any of
+ * the signals, but do not reschedule. The caller shall call
+ * lReschedule() if this function returns 1. Waking several tasks
+ * and then rescheduling once makes a single scheduling pass.
+ */
+int wakeup(Lib *lib, Task *task, unsigned int sigmask) {
+  int ret;
+
+  ret = 0;
   lObtainIntLock(lib, &lib->tasklock);
   task->sigrecvd |= sigmask;
   if (task->state != TS_WAIT) {
@@ -169,13 +218,44 @@ void iSignal(Lib *lib, Task *task, unsigned int sigmask) {
   }
   iRemove(lib, &task->node);
   task->state = TS_READY;
+#if CFG_TASKSTATS
+  task->readystamp = port_get_timestamp();
+#endif
+#if CFG_LATENCY
+  task->wakestamp = port_get_timestamp();
+  task->waker = port_ThisTask(lib);
+#endif
   iEnqueue(lib, &lib->taskready, &task->node);
-  lReleaseIntLock(lib, &lib->tasklock);
-  lReschedule(lib);
-  return;
+  ret = 1;
 
 out:
   lReleaseIntLock(lib, &lib->tasklock);
+  return ret;
+}
+
+void iSignal(Lib *lib, Task *task, unsigned int sigmask) {
+  if (wakeup(lib, task, sigmask)) {
+    lReschedule(lib);
+  }
+}
+
+void wakeall(Lib *lib, List *wake) {
+  Node *node;
+  Node *succ;
+  int doreschedule;
+
+  /*
+   * The Waiter nodes live on the stack of the waiting tasks so
+   * read succ before the owner of a node is signaled.
+   */
+  doreschedule = 0;
+  for (node = wake->head; node->succ; node = succ) {
+    succ = node->succ;
+    doreschedule |= wakeup(lib, ((Waiter *) node)->task, SIGF_SINGLE);
+  }
+  if (doreschedule) {
+    lReschedule(lib);
+  }
 }
 
 unsigned int iWait(Lib *lib, unsigned int sigmask) {
@@ -200,6 +280,10 @@ unsigned int iWait(Lib *lib, unsigned int sigmask) {
     lReleaseIntLock(lib, &lib->tasklock);
 
     lSwitch(lib);
+    /* Woken before it was switched out, nothing to measure. */
+#if CFG_LATENCY
+    task->waker = NULL;
+#endif
   }
   KASSERT(task->state == TS_READY);
 
@@ -0,0 +1,264 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Task CPU time and switch accounting */
+
+#include <priv.h>
+#include <port.h>
+#include <exec/atomic.h>
+
+/*
+ * switch_tasks() charges the time since Task.statstamp to runtime
+ * when a task leaves the CPU, and the time since it became ready to
+ * readytime when it enters one. Only the CPU the task switches on
+ * writes these fields, and not both at once: the next CPU runs the
+ * task only after port_switch_tasks() has detached it from the
+ * previous one. So no lock is taken. The writer makes statseq odd
+ * during the update and GetTaskStats() retries a copy made while
+ * it was odd or changed, so the 64-bit times are not read half
+ * written. wakeup() only sets readystamp.
+ *
+ * The idle task of a CPU runs when the CPU has nothing else to do,
+ * so its runtime is the idle time.
+ *
+ * ARMv6-M has no port_get_timestamp() counter and can not be
+ * built with CFG_TASKSTATS 1.
+ */
+
+enum {
+  /* ReportTaskStats() lines copied per tasklock section */
+  NREPORT  = 8,
+  NAMELEN  = 11,
+};
+
+#if CFG_TASKSTATS
+/* return the later of two timestamps */
+static unsigned long later(unsigned long a, unsigned long b) {
+  return (long) (a - b) < 0 ? b : a;
+}
+
+static void writebegin(Lib *lib, Task *task) {
+  task->statseq++;
+  atomic_release(lib);
+}
+
+static void writeend(Lib *lib, Task *task) {
+  atomic_release(lib);
+  task->statseq++;
+}
+
+/* task leaves the CPU, to wait or end if not TS_READY */
+void stat_switchout(Lib *lib, Task *task) {
+  unsigned long now;
+
+  now = port_get_timestamp();
+  writebegin(lib, task);
+  task->stats.runtime += now - task->statstamp;
+  if (task->state == TS_READY) {
+    task->stats.ninvoluntary++;
+  } else {
+    task->stats.nvoluntary++;
+  }
+  task->statstamp = now;
+  task->statrunning = 0;
+  writeend(lib, task);
+}
+
+/* Ready since it was switched out or woken, whichever is later. */
+void stat_switchin(Lib *lib, Task *task) {
+  unsigned long now;
+
+  now = port_get_timestamp();
+  writebegin(lib, task);
+  task->stats.readytime += now -
+   later(task->statstamp, task->readystamp);
+  task->stats.nswitch++;
+  task->statstamp = now;
+  task->statrunning = 1;
+  writeend(lib, task);
+}
+
+/* Consistent copy of the fields written by the switches */
+static int readstats(Lib *lib, const Task *task, TaskStats *stats,
+ unsigned long *stamp) {
+  unsigned int seq;
+  int running;
+
+  do {
+    while ((seq = task->statseq) & 1) {
+      ;
+    }
+    atomic_acquire(lib);
+    *stats = task->stats;
+    *stamp = task->statstamp;
+    running = task->statrunning;
+    atomic_acquire(lib);
+  } while (seq != task->statseq);
+  return running;
+}
+#endif
+
+/* Must hold tasklock. There is no ExecCPU on ARMv6-M. */
+static int isrunning(Lib *lib, const Task *task) {
+  if (task == port_ThisTask(lib)) {
+    return 1;
+  }
+  for (Node *node = lib->cpuonline.head; node->succ;
+   node = node->succ) {
+    if (((ExecCPU *) node)->thistask == task) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Must hold tasklock. Adds the time since the last switch. */
+static void getstats(Lib *lib, const Task *task, TaskStats *stats) {
+#if CFG_TASKSTATS
+  unsigned long stamp;
+  unsigned long now;
+
+  if (readstats(lib, task, stats, &stamp)) {
+    now = port_get_timestamp();
+    stats->runtime += now - stamp;
+  } else if (task->state == TS_READY) {
+    now = port_get_timestamp();
+    stats->readytime += now - later(stamp, task->readystamp);
+  }
+#else
+  *stats = (TaskStats) { 0 };
+#endif
+}
+
+/* Must hold tasklock. runtime since the previous call. */
+static unsigned long long newruntime(Task *task, const TaskStats *s) {
+#if CFG_TASKSTATS
+  unsigned long long d;
+
+  d = s->runtime - task->statreported;
+  task->statreported = s->runtime;
+  return d;
+#else
+  return 0;
+#endif
+}
+
+void iGetTaskStats(Lib *lib, Task *task, TaskStats *stats) {
+  lObtainIntLock(lib, &lib->tasklock);
+  getstats(lib, task, stats);
+  lReleaseIntLock(lib, &lib->tasklock);
+}
+
+static void putfmt(Lib *lib, void (*put)(void *arg, int c), void *arg,
+ const char *fmt, ...) {
+  va_list ap;
+
+  va_start(ap, fmt);
+  lRawDoFmt(lib, put, arg, fmt, ap);
+  va_end(ap);
+}
+
+/* One task in ReportTaskStats(), copied under tasklock */
+struct statline {
+  TaskStats        s;
+  unsigned long    drun;
+  int              pri;
+  char             state[2];
+  char             name[NAMELEN + 1];
+};
+
+/* R running, r ready, w waiting */
+static char statechar(Lib *lib, const Task *task) {
+  if (task->state != TS_READY) {
+    return 'w';
+  }
+  return isrunning(lib, task) ? 'R' : 'r';
+}
+
+static void copyline(Lib *lib, struct statline *line, Task *task) {
+  const char *s;
+  int i;
+
+  getstats(lib, task, &line->s);
+  line->drun = newruntime(task, &line->s);
+  line->pri = task->node.pri;
+  line->state[0] = statechar(lib, task);
+  line->state[1] = '\0';
+  s = task->node.name ? task->node.name : "-";
+  for (i = 0; i < NAMELEN && s[i]; i++) {
+    line->name[i] = s[i];
+  }
+  line->name[i] = '\0';
+}
+
+/*
+ * Copy up to NREPORT tasks after the first skip ones on taskready
+ * and taskwait. Return the number copied.
+ */
+static int copylines(Lib *lib, struct statline *lines, int skip) {
+  List *lists[2];
+  int n;
+
+  lists[0] = &lib->taskready;
+  lists[1] = &lib->taskwait;
+  n = 0;
+  lObtainIntLock(lib, &lib->tasklock);
+  for (int i = 0; i < 2; i++) {
+    for (Node *node = lists[i]->head; node->succ && n < NREPORT;
+     node = node->succ) {
+      if (skip) {
+        skip--;
+        continue;
+      }
+      copyline(lib, &lines[n++], (Task *) node);
+    }
+  }
+  lReleaseIntLock(lib, &lib->tasklock);
+  return n;
+}
+
+/*
+ * The tasks are copied NREPORT at a time under tasklock and
+ * printed after it is released, so put may be slow or use exec.
+ * Tasks which are added or removed meanwhile may be missed or
+ * shown twice.
+ */
+void iReportTaskStats(Lib *lib, void (*put)(void *arg, int c),
+ void *arg) {
+  struct statline *lines;
+  unsigned long now;
+  unsigned long dt;
+  int skip;
+  int n;
+
+  lines = lAllocMem(lib, NREPORT * sizeof *lines, MEMF_ANY);
+  if (lines == NULL) {
+    return;
+  }
+  lObtainIntLock(lib, &lib->tasklock);
+  now = port_get_timestamp();
+  dt = now - lib->statstamp;
+  lib->statstamp = now;
+  lReleaseIntLock(lib, &lib->tasklock);
+  putfmt(lib, put, arg, "%-10s %4s %2s %4s %10s %10s %8s %8s %8s\n",
+   "task", "pri", "st", "cpu%", "run/1000", "ready/1000", "switch",
+   "vol", "invol");
+  skip = 0;
+  do {
+    n = copylines(lib, lines, skip);
+    for (int i = 0; i < n; i++) {
+      const struct statline *l = &lines[i];
+
+      putfmt(lib, put, arg,
+       "%-10s %4d %2s %4lu %10lu %10lu %8lu %8lu %8lu\n",
+       l->name, l->pri, l->state,
+       dt / 100 ? l->drun / (dt / 100) : 0,
+       (unsigned long) (l->s.runtime / 1000),
+       (unsigned long) (l->s.readytime / 1000),
+       l->s.nswitch, l->s.nvoluntary, l->s.ninvoluntary);
+    }
+    skip += n;
+  } while (n == NREPORT);
+  lFreeMem(lib, lines, NREPORT * sizeof *lines);
+}
+
@@ -0,0 +1,16 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Per-CPU work queues, SMP version */
+
+#include <priv.h>
+#include <port.h>
+
+/*
+ * The caller may migrate after reading the CPU id. That only costs
+ * a shared lock, the item is still queued.
+ */
+WorkQueue *localwork(Lib *lib) {
+  return &lib->workq[port_get_cpu()->id % lib->nworkq];
+}
+
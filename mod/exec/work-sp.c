@@ -0,0 +1,12 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Per-CPU work queues, single processor version */
+
+#include <priv.h>
+#include <port.h>
+
+WorkQueue *localwork(Lib *lib) {
+  return &lib->workq[0];
+}
+
@@ -0,0 +1,149 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Per-CPU work queues */
+
+#include <limits.h>
+#include <priv.h>
+#include <port.h>
+#include <exec/atomic.h>
+
+/*
+ * There is one WorkQueue with a worker task per CPU. QueueWork()
+ * normally adds to the queue of the calling CPU, so its lock is
+ * only shared with the worker.
+ *
+ * Work.queue is claimed with compare-and-swap when the item is
+ * queued, so an item is on at most one queue. The worker releases
+ * it before the code runs and does not touch it afterwards. This
+ * lets the code queue the item again or free it.
+ *
+ * The scheduler has no CPU affinity, so a worker is not pinned to
+ * its CPU.
+ *
+ * Workers run code from other modules, including LightTasks, so
+ * their stack size is CFG_WORKSTACK rather than the minstack of
+ * the port.
+ */
+
+static void worker(Lib *lib) {
+  WorkQueue *q;
+  Work *work;
+  int ncancel;
+
+  q = port_ThisTask(lib)->user;
+  iAllocSignal(lib, SIGB_WORK);
+  KASSERT(port_ThisTask(lib)->sigalloc & SIGF_WORK);
+
+  while (1) {
+    lObtainIntLock(lib, &q->lock);
+    work = (Work *) iRemHead(lib, &q->list);
+    if (work) {
+      work->node.type = NT_UNKNOWN;
+      work->queue = NULL;
+    }
+    q->running = work;
+    lReleaseIntLock(lib, &q->lock);
+    if (work == NULL) {
+      lWait(lib, SIGF_WORK);
+      continue;
+    }
+
+    work->code(lib, work);
+
+    lObtainIntLock(lib, &q->lock);
+    q->running = NULL;
+    q->done++;
+    ncancel = q->ncancel;
+    lReleaseIntLock(lib, &q->lock);
+    if (ncancel) {
+      lWakeAddress(lib, &q->done, INT_MAX);
+    }
+  }
+}
+
+void startwork(Lib *lib) {
+  WorkQueue *q;
+  int n;
+
+  n = port_get_ncpu(lib);
+  q = lAllocMem(lib, n * sizeof *q, MEMF_CLEAR | MEMF_ANY);
+  KASSERT(q);
+  for (int i = 0; i < n; i++) {
+    char *tname;
+
+    tname = lAllocMem(lib, 8, MEMF_ANY);
+    KASSERT(tname);
+    lMemMove(lib, tname, "workx", 6);
+    tname[4] = '0' + i;
+    iNewList(lib, &q[i].list);
+    lInitIntLock(lib, &q[i].lock);
+    q[i].task = iCreateTask(lib, tname, 10, worker, &q[i], NULL,
+     CFG_WORKSTACK);
+    KASSERT(q[i].task);
+  }
+  lib->nworkq = n;
+  atomic_release(lib);
+  lib->workq = q;
+}
+
+int iQueueWork(Lib *lib, Work *work, int cpu) {
+  WorkQueue *q;
+
+  if (cpu == WORK_ANYCPU) {
+    q = localwork(lib);
+  } else {
+    KASSERT(0 <= cpu);
+    q = &lib->workq[cpu % lib->nworkq];
+  }
+  if (atomic_cas_ptr(lib, &work->queue, NULL, q) != NULL) {
+    return 0;
+  }
+  lObtainIntLock(lib, &q->lock);
+  work->node.type = NT_WORK;
+  iAddTail(lib, &q->list, &work->node);
+  lReleaseIntLock(lib, &q->lock);
+  lSignal(lib, q->task, SIGF_WORK);
+  return 1;
+}
+
+int iCancelWork(Lib *lib, Work *work) {
+  WorkQueue *q;
+  int ret;
+
+  ret = 0;
+  q = work->queue;
+  if (q) {
+    lObtainIntLock(lib, &q->lock);
+    /* It may be between the claim and AddTail() in QueueWork(). */
+    if (work->node.type == NT_WORK) {
+      iRemove(lib, &work->node);
+      work->node.type = NT_UNKNOWN;
+      work->queue = NULL;
+      ret = 1;
+    }
+    lReleaseIntLock(lib, &q->lock);
+  }
+
+  for (int i = 0; i < lib->nworkq; i++) {
+    unsigned int done;
+
+    q = &lib->workq[i];
+    if (q->task == port_ThisTask(lib)) {
+      /* The code cancels itself. */
+      continue;
+    }
+    lObtainIntLock(lib, &q->lock);
+    while (q->running == work) {
+      q->ncancel++;
+      done = q->done;
+      lReleaseIntLock(lib, &q->lock);
+      lWaitAddress(lib, &q->done, done);
+      lObtainIntLock(lib, &q->lock);
+      q->ncancel--;
+    }
+    lReleaseIntLock(lib, &q->lock);
+  }
+  return ret;
+}
+
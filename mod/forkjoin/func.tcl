@@ -0,0 +1,50 @@
+# SPDX-License-Identifier: GPL-2.0
+# Copyright 2022 Martin Åberg
+
+mod_base        ForkJoinBase
+mod_basetype    ForkJoinBase
+mod_libname     forkjoin.library
+mod_prefix      forkjoin
+mod_struct      ExecBase
+mod_struct      ForkJoinBase
+
+func_begin      ParallelFor
+func_return     "void"
+func_param      "long" begin
+func_param      "long" end
+func_param      "long" grain
+func_param      "void (*fn)(struct ExecBase *exec, void *data, long begin, long end)" fn isfunc
+func_param      "void *" data
+func_short      "run a loop on all CPUs"
+func_long       "
+Call fn(exec, data, b, e) for disjoint ranges of indices from b
+up to but not including e, which together cover the range from
+begin to end. Each range has at most grain elements. The calls
+are made by the calling task and by worker tasks, one per
+additional CPU, and return when all calls have returned.
+
+The range is split in halves until it is no larger than grain.
+One half is kept and the other is pushed on a work-stealing
+deque where idle workers can take it. So the number of ranges
+handed between tasks grows with the number of CPUs, not with the
+number of elements. grain shall be large enough for fn to
+amortize the cost of a steal, typically some microseconds of
+work.
+
+fn shall not call ParallelFor(). Only one ParallelFor() runs at a
+time, other callers wait.
+"
+func_see        "SetParallelism()"
+
+func_begin      SetParallelism
+func_return     "int"
+func_param      "int" n
+func_short      "set number of tasks for ParallelFor()"
+func_long       "
+Limit ParallelFor() to the calling task and n - 1 worker tasks.
+n is clamped to the range from 1 to the number of CPUs. This is
+intended for measuring speedup.
+"
+func_result     "the previous value"
+func_see        "ParallelFor()"
+
@@ -0,0 +1,336 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+#include <limits.h>
+#include <exec/libcall.h>
+#include <exec/atomic.h>
+#include <exec/execbase.h>
+#include <exec/memory.h>
+#include <exec/resident.h>
+#include <exec/tasks.h>
+#include <forkjoin/forkjoin.h>
+#include "internal.h"
+
+typedef struct ForkJoinBase     Lib;
+typedef struct ForkJoinDeque    Deque;
+
+/*
+ * Each deque is owned by one task, which pushes and pops at the
+ * bottom. Other tasks steal from the top. This is the Chase-Lev
+ * algorithm with a fixed buffer: splitting in halves pushes at
+ * most one range per bit of the element count, so DEQUE_SIZE is
+ * never exceeded in practice. If it is, the owner runs the range
+ * itself.
+ *
+ * An owner only races with thieves for the last range, which is
+ * settled by compare-and-swap on top. A thief reads the range
+ * before its compare-and-swap, and the owner can only reuse that
+ * slot after top has passed it, so a stale read makes it fail.
+ */
+
+enum {
+  DEQUE_SIZE    = 64,
+  WORKER_PRI    = 0,
+  WORKER_STACK  = 4096,
+};
+
+struct range {
+  long begin;
+  long end;
+};
+
+struct ForkJoinDeque {
+  volatile AtomicInteger top;
+  volatile AtomicInteger bottom;
+  Lib                 *fj;
+  int                  id;
+  struct range         item[DEQUE_SIZE];
+};
+
+static int push(Lib *fj, Deque *d, long begin, long end) {
+  AtomicInteger b;
+
+  b = d->bottom;
+  if (b - d->top >= DEQUE_SIZE) {
+    return 0;
+  }
+  d->item[b % DEQUE_SIZE].begin = begin;
+  d->item[b % DEQUE_SIZE].end = end;
+  atomic_release(fj->exec);
+  d->bottom = b + 1;
+  return 1;
+}
+
+static int pop(Lib *fj, Deque *d, struct range *r) {
+  AtomicInteger b;
+  AtomicInteger t;
+  int ok;
+
+  b = d->bottom - 1;
+  d->bottom = b;
+  atomic_fence(fj->exec);
+  t = d->top;
+  if ((int) (b - t) < 0) {
+    d->bottom = b + 1;
+    return 0;
+  }
+  *r = d->item[b % DEQUE_SIZE];
+  ok = 1;
+  if (b == t) {
+    /* the last one, thieves may want it too */
+    ok = atomic_cas(fj->exec, &d->top, t, t + 1) == t;
+    d->bottom = t + 1;
+  }
+  return ok;
+}
+
+static int steal(Lib *fj, Deque *d, struct range *r) {
+  AtomicInteger b;
+  AtomicInteger t;
+
+  t = d->top;
+  atomic_fence(fj->exec);
+  b = d->bottom;
+  if ((int) (b - t) <= 0) {
+    return 0;
+  }
+  atomic_acquire(fj->exec);
+  *r = d->item[t % DEQUE_SIZE];
+  return atomic_cas(fj->exec, &d->top, t, t + 1) == t;
+}
+
+/* Visit the other deques, starting after our own. */
+static int stealany(Lib *fj, Deque *d, struct range *r) {
+  int n;
+
+  n = fj->nactive;
+  for (int i = 1; i < n; i++) {
+    if (steal(fj, fj->deque[(d->id + i) % n], r)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void wakeall(Lib *fj) {
+  atomic_add(fj->exec, &fj->event, 1);
+  if (fj->sleepers) {
+    lWakeAddress(fj->exec, &fj->event, INT_MAX);
+  }
+}
+
+static void execute(Lib *fj, Deque *d, struct range r) {
+  struct ExecBase *exec;
+
+  exec = fj->exec;
+  while (r.end - r.begin > fj->grain) {
+    long mid;
+
+    mid = r.begin + (r.end - r.begin) / 2;
+    atomic_add(exec, &fj->pending, 1);
+    if (!push(fj, d, mid, r.end)) {
+      atomic_add(exec, &fj->pending, -1);
+      break;
+    }
+    /* A thief waits for the next push when it found nothing. */
+    atomic_add(exec, &fj->event, 1);
+    if (fj->sleepers) {
+      lWakeAddress(exec, &fj->event, 1);
+    }
+    r.end = mid;
+  }
+  while (r.begin < r.end) {
+    long e;
+
+    e = r.end - r.begin > fj->grain ? r.begin + fj->grain : r.end;
+    fj->fn(exec, fj->data, r.begin, e);
+    r.begin = e;
+  }
+  if (atomic_add(exec, &fj->pending, -1) == 1) {
+    wakeall(fj);
+  }
+}
+
+/*
+ * Take part in the current ParallelFor() until all ranges are
+ * done. event is read before pending, so if the last range
+ * finishes after that, event has changed and WaitAddress()
+ * returns.
+ */
+static void participate(Lib *fj, Deque *d) {
+  struct ExecBase *exec;
+
+  exec = fj->exec;
+  while (1) {
+    struct range r;
+    unsigned int seen;
+
+    seen = fj->event;
+    atomic_acquire(exec);
+    if (fj->pending == 0) {
+      break;
+    }
+    if (pop(fj, d, &r) || stealany(fj, d, &r)) {
+      execute(fj, d, r);
+      continue;
+    }
+    atomic_add(exec, &fj->sleepers, 1);
+    lWaitAddress(exec, &fj->event, seen);
+    atomic_add(exec, &fj->sleepers, -1);
+  }
+}
+
+static void worker(struct ExecBase *exec) {
+  Deque *d;
+  Lib *fj;
+  unsigned int gen;
+
+  d = lFindTask(exec)->user;
+  fj = d->fj;
+  gen = 0;
+  while (1) {
+    while (fj->generation == gen) {
+      lWaitAddress(exec, &fj->generation, gen);
+    }
+    gen = fj->generation;
+    atomic_acquire(exec);
+    if (d->id < fj->nactive) {
+      participate(fj, d);
+    }
+  }
+}
+
+void iParallelFor(
+  Lib *fj,
+  long begin,
+  long end,
+  long grain,
+  void (*fn)(struct ExecBase *exec, void *data, long begin, long end),
+  void *data
+) {
+  struct ExecBase *exec;
+  Deque *d;
+
+  if (end <= begin) {
+    return;
+  }
+  exec = fj->exec;
+  d = fj->deque[0];
+  lObtainMutex(exec, &fj->lock);
+  fj->grain = 0 < grain ? grain : 1;
+  fj->fn = fn;
+  fj->data = data;
+  fj->pending = 1;
+  push(fj, d, begin, end);
+  atomic_release(exec);
+  fj->generation++;
+  if (1 < fj->nactive) {
+    lWakeAddress(exec, &fj->generation, INT_MAX);
+  }
+  participate(fj, d);
+  lReleaseMutex(exec, &fj->lock);
+}
+
+int iSetParallelism(Lib *fj, int n) {
+  int old;
+
+  if (n < 1) {
+    n = 1;
+  }
+  if (fj->ndeque < n) {
+    n = fj->ndeque;
+  }
+  lObtainMutex(fj->exec, &fj->lock);
+  old = fj->nactive;
+  fj->nactive = n;
+  lReleaseMutex(fj->exec, &fj->lock);
+  return old;
+}
+
+struct Segment *iExpungeBase(struct Library *lib) {
+  return NULL;
+}
+
+void iCloseBase(struct Library *lib) {
+}
+
+struct Library *iOpenBase(struct Library *lib) {
+  return lib;
+}
+
+static void freedeques(Lib *lib, int first, int n) {
+  for (int i = first; i < n; i++) {
+    lFreeMem(lib->exec, lib->deque[i], sizeof *lib->deque[i]);
+  }
+}
+
+/*
+ * All memory is allocated before the first worker is created, so
+ * init() fails without tasks to stop. If a worker can not be
+ * created, the library runs with the deques it has workers for.
+ */
+static struct Library *init(
+  struct ExecBase *exec,
+  struct Library *library,
+  struct Segment *segment
+) {
+  Lib *lib;
+  int n;
+
+  lib = (Lib *) library;
+  lib->exec = exec;
+  lib->lib.opencount++;
+  lInitMutex(exec, &lib->lock);
+
+  n = lGetCPUCount(exec);
+  lib->deque = lAllocMem(exec, n * sizeof *lib->deque,
+   MEMF_CLEAR | MEMF_ANY);
+  if (lib->deque == NULL) {
+    return NULL;
+  }
+  for (int i = 0; i < n; i++) {
+    Deque *d;
+
+    d = lAllocMem(exec, sizeof *d, MEMF_CLEAR | MEMF_ANY);
+    if (d == NULL) {
+      freedeques(lib, 0, i);
+      lFreeMem(exec, lib->deque, n * sizeof *lib->deque);
+      return NULL;
+    }
+    d->fj = lib;
+    d->id = i;
+    lib->deque[i] = d;
+  }
+  lib->ndeque = 1;
+  for (int i = 1; i < n; i++) {
+    if (lCreateTask(exec, "forkjoin", WORKER_PRI, worker,
+     lib->deque[i], NULL, WORKER_STACK) == NULL) {
+      freedeques(lib, i, n);
+      break;
+    }
+    lib->ndeque = i + 1;
+  }
+  lib->nactive = lib->ndeque;
+
+  return library;
+}
+
+const struct Resident RES0 = {
+  .matchword          = RTC_MATCHWORD,
+  .matchtag           = &RES0,
+  .endskip            = &((struct Resident *) (&RES0))[1],
+  .info.name          = "forkjoin.library",
+  .info.idstring      = "forkjoin 0.1 2022-10-19",
+  .info.type          = NT_LIBRARY,
+  .info.version       = 1,
+  .pri                = 0,
+  .flags              = RTF_AUTOINIT | 2,
+  .init.iauto.f       = init,
+  .init.iauto.optable = &optemplate,
+  .init.iauto.opsize  = sizeof (struct ForkJoinBaseOp),
+  .init.iauto.possize = sizeof (Lib),
+};
+
+int _start(void);
+int _start(void) { return -1; }
+
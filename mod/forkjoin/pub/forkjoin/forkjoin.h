@@ -0,0 +1,43 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+#ifndef FORKJOIN_FORKJOIN_H
+#define FORKJOIN_FORKJOIN_H
+
+#include <exec/libraries.h>
+#include <exec/mutex.h>
+
+struct ExecBase;
+struct ForkJoinBase;
+struct ForkJoinDeque;
+
+struct ForkJoinBase {
+  struct Library       lib;
+  struct ExecBase     *exec;
+  /* one ParallelFor() at a time */
+  struct Mutex         lock;
+  /* deque[0] is used by the caller, the others by a worker task */
+  struct ForkJoinDeque **deque;
+  int                  ndeque;
+  /* number of deques taking part, see SetParallelism() */
+  int                  nactive;
+  /* incremented when a ParallelFor() starts */
+  volatile unsigned int generation;
+  /* incremented when a range is pushed and when all are done */
+  volatile unsigned int event;
+  /* tasks waiting for event */
+  volatile AtomicInteger sleepers;
+  /* ranges pushed but not yet finished */
+  volatile AtomicInteger pending;
+  long                 grain;
+  void               (*fn)(
+    struct ExecBase *exec,
+    void *data,
+    long begin,
+    long end
+  );
+  void                *data;
+};
+
+#endif
+
@@ -94,8 +94,11 @@ struct DevUnit {
   struct Node        node;
   volatile struct pl011_regs *regs;
   struct Interrupt   interrupt;
+  struct Interrupt   softint;
   struct {
     struct List        list;
+    /* completed by the isr, replied by softint */
+    struct List        done;
     struct IntLock     lock;
     int                r;
     int                w;
@@ -103,6 +106,7 @@ struct DevUnit {
   } rx;
   struct {
     struct List        list;
+    struct List        done;
     struct IntLock     lock;
   } tx;
   int                num;
@@ -149,7 +153,7 @@ static void iAbortIO(struct Device *dev, struct IORequest *ior) {
         lRemove(exec, &req->ior.message.node);
         abort = 1;
       } else {
-        /* already replied or in the process of being replied in isr */
+        /* already replied or waiting on rx.done to be replied */
       }
       lReleaseIntLock(exec, &u->rx.lock);
       break;
@@ -190,11 +194,13 @@ static void finihw(struct DevUnit *u) {
   regs->cr = 0;
 }
 
-static void isr_tx(
+static int isr_tx(
   struct ExecBase *exec,
   struct DevUnit *u,
   volatile struct pl011_regs *const regs
 ) {
+  int ndone = 0;
+
   lObtainIntLock(exec, &u->tx.lock);
   while (1) {
     struct IOExtSer *req = (struct IOExtSer *) lGetHead(exec, &u->tx.list);
@@ -210,27 +216,27 @@ static void isr_tx(
     if (req->actual == req->length) {
       lRemove(exec, &req->ior.message.node);
       req->ior.message.node.type = NT_FREEMSG;
-      lReleaseIntLock(exec, &u->tx.lock);
-      lReplyMsg(exec, &req->ior.message);
-      dbg("%s: replied\n", __func__);
-      lObtainIntLock(exec, &u->tx.lock);
+      lAddTail(exec, &u->tx.done, &req->ior.message.node);
+      ndone++;
     }
     if (regs->fr & FR_TXFF) {
         break;
     }
   }
   lReleaseIntLock(exec, &u->tx.lock);
+  return ndone;
 }
 
 /* INVARIANT: rx.buf  has data   => rx.list is empty */
 /* INVARIANT: rx.list has req(s) => rx.buf  is empty */
-static void isr_rx(
+static int isr_rx(
   struct ExecBase *exec,
   struct DevUnit *u,
   volatile struct pl011_regs *const regs
 ) {
   unsigned char rxdata[32];
   int nrx = 0;
+  int ndone = 0;
 
   while ((nrx < (int) NELEM(rxdata)) &&
    !(regs->fr & FR_RXFE)) {
@@ -238,7 +244,7 @@ static void isr_rx(
     nrx++;
   }
   if (nrx == 0) {
-    return;
+    return 0;
   }
 
   int i = 0;
@@ -256,18 +262,13 @@ static void isr_rx(
     if (req->actual == req->length) {
       lRemove(exec, &req->ior.message.node);
       req->ior.message.node.type = NT_FREEMSG;
-
-      lReleaseIntLock(exec, &u->rx.lock);
       /*
-       * NOTE: AbortIO(req) may be called here.  If AbortIO() sees NT_FREEMSG
-       * (after taking the lock), then it will ignore the abort and WaitIO()
-       * will soon see NT_REPLYMSG.
-       *
-       * NOTE: cmd_read() may be called here to add new requests on rx.list.
+       * NOTE: If AbortIO() sees NT_FREEMSG (after taking the lock),
+       * then it will ignore the abort and WaitIO() will soon see
+       * NT_REPLYMSG, when the software interrupt has replied.
        */
-      lReplyMsg(exec, &req->ior.message);
-      dbg("%s: replied\n", __func__);
-      lObtainIntLock(exec, &u->rx.lock);
+      lAddTail(exec, &u->rx.done, &req->ior.message.node);
+      ndone++;
     } else {
       break;
     }
@@ -292,13 +293,47 @@ static void isr_rx(
   if (full) {
     dbg("%s: full\n", __func__);
   }
+  return ndone;
+}
+
+/* Reply the requests which the isr has completed. */
+static void replydone(
+  struct ExecBase *exec,
+  struct List *done,
+  struct IntLock *lock
+) {
+  while (1) {
+    struct Message *msg;
+
+    lObtainIntLock(exec, lock);
+    msg = (struct Message *) lRemHead(exec, done);
+    lReleaseIntLock(exec, lock);
+    if (msg == NULL) {
+      break;
+    }
+    lReplyMsg(exec, msg);
+    dbg("%s: replied\n", __func__);
+  }
+}
+
+/* Caused by the isr, runs with interrupts enabled. */
+static void softint(struct ExecBase *exec, void *data) {
+  struct DevUnit *u = (struct DevUnit *) data;
+
+  replydone(exec, &u->rx.done, &u->rx.lock);
+  replydone(exec, &u->tx.done, &u->tx.lock);
 }
 
 static void isr(struct ExecBase *exec, void *data) {
   struct DevUnit *u = (struct DevUnit *) data;
   volatile struct pl011_regs *const regs = u->regs;
-  isr_rx(exec, u, regs);
-  isr_tx(exec, u, regs);
+  int ndone;
+
+  ndone = isr_rx(exec, u, regs);
+  ndone += isr_tx(exec, u, regs);
+  if (ndone) {
+    lCause(exec, &u->softint);
+  }
 }
 
 static int cmd_write(struct DevBase *d, struct DevUnit *u,
@@ -424,6 +459,7 @@ static void iClose(struct Device *dev, struct IORequest *ior) {
   dbg("%s: entry\n", __func__);
   lObtainMutex(exec, &d->unitlock);
   lRemIntServer(exec, &u->interrupt, DEV0_INTERRUPT);
+  /* The softint has also run when the isr is removed. */
   finihw(u);
   lRemove(exec, &u->node);
   ior->unit = NULL;
@@ -474,8 +510,10 @@ static void iOpen(
   ior->unit = (struct Unit *) u;
 
   lNewList(exec, &u->rx.list);
+  lNewList(exec, &u->rx.done);
   lInitIntLock(exec, &u->rx.lock);
   lNewList(exec, &u->tx.list);
+  lNewList(exec, &u->tx.done);
   lInitIntLock(exec, &u->tx.lock);
 
   u->regs = (void *) DEV0_REGADDR;
@@ -483,6 +521,9 @@ static void iOpen(
   u->interrupt.node.name = RES0.info.name;
   u->interrupt.data = u;
   u->interrupt.code = isr;
+  u->softint.node.name = RES0.info.name;
+  u->softint.data = u;
+  u->softint.code = softint;
   lAddTail(exec, &d->unitlist, &u->node);
   lReleaseMutex(exec, &d->unitlock);
   inithw(u);
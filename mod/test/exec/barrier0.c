@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Barrier test and round-trip benchmark */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  ROUNDS   = 1000,
+};
+
+static struct Barrier bar;
+static struct Semaphore finished;
+static struct IntLock arrivedlock;
+static int ntask;
+static int arrived;
+static unsigned long tstart;
+static unsigned long tend;
+
+static void phase(struct ExecBase *exec) {
+  /* Warm-up round so that all tasks have started. */
+  if (lWaitBarrier(exec, &bar)) {
+    tstart = lGetTimeStamp(exec);
+  }
+  for (int i = 0; i < ROUNDS; i++) {
+    lObtainIntLock(exec, &arrivedlock);
+    arrived++;
+    lReleaseIntLock(exec, &arrivedlock);
+    if (lWaitBarrier(exec, &bar)) {
+      /* Everyone has arrived and nobody has passed the next one. */
+      vtest(arrived == ntask * (i + 1));
+    }
+    lWaitBarrier(exec, &bar);
+  }
+  if (lWaitBarrier(exec, &bar)) {
+    tend = lGetTimeStamp(exec);
+  }
+  lReleaseSemaphore(exec, &finished, 1);
+}
+
+#define STACK_SIZE 1024
+void test_barrier0(struct ExecBase *exec) {
+  static const int nharts[] = { 2, 4, 8 };
+  int ncpu;
+
+  lInitSemaphore(exec, &finished, 0);
+  lInitIntLock(exec, &arrivedlock);
+  ncpu = lGetCPUCount(exec);
+  kprintf(exec, "barrier: %d rounds\n", ROUNDS);
+  for (unsigned int k = 0; k < sizeof nharts / sizeof nharts[0]; k++) {
+    ntask = nharts[k];
+    arrived = 0;
+    lInitBarrier(exec, &bar, ntask);
+    for (int i = 0; i < ntask; i++) {
+      struct Task *task;
+
+      task = lCreateTask(exec, "phase", 1, phase, NULL, NULL,
+       STACK_SIZE);
+      vtest(task);
+    }
+    for (int i = 0; i < ntask; i++) {
+      lObtainSemaphore(exec, &finished);
+    }
+    vtest(arrived == ntask * ROUNDS);
+    /* two barriers per round */
+    kprintf(exec, "barrier: %d tasks on %d CPUs: %lu ticks for %d "
+     "round trips\n", ntask, ncpu, tend - tstart, 2 * ROUNDS);
+  }
+}
+
@@ -0,0 +1,151 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Coroutines, and their switch cost compared to a task switch */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NSWITCH  = 1000,
+  NSTEP    = 3,
+  NMSG     = 100,
+  NYIELD   = 50,
+};
+
+static int nstep;
+
+static void stepper(struct ExecBase *exec, struct Coroutine *co) {
+  vtest(co->user == &nstep);
+  for (int i = 0; i < NSTEP; i++) {
+    nstep++;
+    lYieldCoroutine(exec);
+  }
+}
+
+static void spinner(struct ExecBase *exec, struct Coroutine *co) {
+  while (1) {
+    lYieldCoroutine(exec);
+  }
+}
+
+static struct Task *pingtask;
+static int pongsig;
+static int pingsig;
+
+static void ponger(struct ExecBase *exec) {
+  pingsig = lAllocSignal(exec, -1);
+  vtest(0 <= pingsig);
+  lSignal(exec, pingtask, 1U << pongsig);
+  for (int i = 0; i < NSWITCH; i++) {
+    lWait(exec, 1U << pingsig);
+    lSignal(exec, pingtask, 1U << pongsig);
+  }
+}
+
+static struct MsgPort *port;
+static int nserved;
+static int nyield;
+
+static void client(struct ExecBase *exec) {
+  struct MsgPort *replyport;
+  struct Message msg;
+
+  replyport = lCreateMsgPort(exec);
+  vtest(replyport);
+  msg.replyport = replyport;
+  for (int i = 0; i < NMSG; i++) {
+    lPutMsg(exec, port, &msg);
+    lWaitMsg(exec, &msg);
+  }
+  lDeleteMsgPort(exec, replyport);
+}
+
+static void server(struct ExecBase *exec, struct Coroutine *co) {
+  struct Message *msg;
+
+  /* The signal bit belongs to the task running the coroutines. */
+  port = lCreateMsgPort(exec);
+  vtest(port);
+  vtest(lCreateTask(exec, "client", 0, client, NULL, NULL, 1024));
+  while (nserved < NMSG) {
+    lAwaitCoroutine(exec, 1U << port->sigbit);
+    while ((msg = lGetMsg(exec, port))) {
+      nserved++;
+      lReplyMsg(exec, msg);
+    }
+  }
+  lDeleteMsgPort(exec, port);
+}
+
+static void yielder(struct ExecBase *exec, struct Coroutine *co) {
+  for (int i = 0; i < NYIELD; i++) {
+    nyield++;
+    lYieldCoroutine(exec);
+  }
+}
+
+#define CO_STACK 2048
+void test_co0(struct ExecBase *exec) {
+  struct Coroutine *co;
+  struct Coroutine *co2;
+  struct List list;
+  unsigned long tstart;
+  unsigned long tco;
+  unsigned long ttask;
+  struct Task *task;
+  int n;
+
+  co = lCreateCoroutine(exec, "stepper", stepper, &nstep, CO_STACK);
+  vtest(co);
+  n = 0;
+  while (lResumeCoroutine(exec, co)) {
+    n++;
+    vtest(nstep == n);
+  }
+  vtest(n == NSTEP);
+  lDeleteCoroutine(exec, co);
+
+  /* Resume and yield, two switches per round trip */
+  co = lCreateCoroutine(exec, "spinner", spinner, NULL, CO_STACK);
+  vtest(co);
+  tstart = lGetTimeStamp(exec);
+  for (int i = 0; i < NSWITCH; i++) {
+    lResumeCoroutine(exec, co);
+  }
+  tco = lGetTimeStamp(exec) - tstart;
+  lDeleteCoroutine(exec, co);
+
+  /* Signal and Wait between two tasks, through port_switch_tasks */
+  pingtask = lFindTask(exec);
+  pongsig = lAllocSignal(exec, -1);
+  vtest(0 <= pongsig);
+  task = lCreateTask(exec, "ponger", 0, ponger, NULL, NULL, 1024);
+  vtest(task);
+  lWait(exec, 1U << pongsig);
+  tstart = lGetTimeStamp(exec);
+  for (int i = 0; i < NSWITCH; i++) {
+    lSignal(exec, task, 1U << pingsig);
+    lWait(exec, 1U << pongsig);
+  }
+  ttask = lGetTimeStamp(exec) - tstart;
+  lFreeSignal(exec, pongsig);
+  kprintf(exec, "co0: %d round trips %lu ticks for coroutines, "
+   "%lu ticks for tasks\n", NSWITCH, tco, ttask);
+
+  /* The yielder continues while the server awaits messages. */
+  lNewList(exec, &list);
+  co = lCreateCoroutine(exec, "server", server, NULL, CO_STACK);
+  vtest(co);
+  lAddTail(exec, &list, &co->node);
+  co2 = lCreateCoroutine(exec, "yielder", yielder, NULL, CO_STACK);
+  vtest(co2);
+  lAddTail(exec, &list, &co2->node);
+  lRunCoroutines(exec, &list);
+  vtest(nserved == NMSG);
+  vtest(nyield == NYIELD);
+  lDeleteCoroutine(exec, co);
+  lDeleteCoroutine(exec, co2);
+}
+
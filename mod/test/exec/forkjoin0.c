@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* ParallelFor() test and speedup benchmark */
+
+#include "test.h"
+#include <exec/atomic.h>
+#include <forkjoin/forkjoin.h>
+#include <forkjoin/libcall.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NELEM    = 4096,
+  GRAIN    = 16,
+  NSTEP    = 200,
+};
+
+static unsigned char visited[NELEM];
+static volatile AtomicInteger total;
+
+static unsigned int compute(long i) {
+  unsigned int x = i;
+
+  for (int k = 0; k < NSTEP; k++) {
+    x = x * 1103515245 + 12345;
+  }
+  return x;
+}
+
+static void body(struct ExecBase *exec, void *data, long begin,
+ long end) {
+  unsigned int sum = 0;
+
+  vtest(begin < end && end - begin <= GRAIN);
+  for (long i = begin; i < end; i++) {
+    visited[i]++;
+    sum += compute(i);
+  }
+  atomic_add(exec, &total, sum);
+}
+
+void test_forkjoin0(struct ExecBase *exec) {
+  struct ForkJoinBase *fj;
+  unsigned int expect;
+  unsigned long t1;
+  int ntask;
+
+  fj = (struct ForkJoinBase *) lOpenLibrary(exec, "forkjoin.library",
+   0);
+  if (fj == NULL) {
+    kprintf(exec, "forkjoin0: no forkjoin.library\n");
+    return;
+  }
+  expect = 0;
+  for (long i = 0; i < NELEM; i++) {
+    expect += compute(i);
+  }
+
+  /* empty range */
+  lParallelFor(fj, 5, 5, GRAIN, body, NULL);
+  vtest(total == 0);
+
+  ntask = lSetParallelism(fj, 1);
+  t1 = 0;
+  for (int n = 1; n <= ntask; n++) {
+    unsigned long tstart;
+    unsigned long t;
+
+    lSetParallelism(fj, n);
+    for (long i = 0; i < NELEM; i++) {
+      visited[i] = 0;
+    }
+    total = 0;
+    tstart = lGetTimeStamp(exec);
+    lParallelFor(fj, 0, NELEM, GRAIN, body, NULL);
+    t = lGetTimeStamp(exec) - tstart;
+    vtest(total == expect);
+    for (long i = 0; i < NELEM; i++) {
+      vtest(visited[i] == 1);
+    }
+    if (n == 1) {
+      t1 = t;
+    }
+    kprintf(exec, "forkjoin0: %d tasks: %lu ticks, speedup %lu%%\n",
+     n, t, t ? 100 * t1 / t : 0);
+  }
+  lCloseLibrary(exec, &fj->lib);
+}
+
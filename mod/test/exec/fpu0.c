@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Floating-point state of tasks across task switches */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NTASK    = 4,
+  NSTEP    = 1000,
+};
+
+static struct Semaphore finished;
+static double result[NTASK];
+
+/* x and y are live in registers over Reschedule(). */
+static double series(struct ExecBase *exec, double seed, int yield) {
+  double x;
+  double y;
+
+  x = 0.0;
+  y = 1.0;
+  for (int i = 0; i < NSTEP; i++) {
+    x = x * 0.5 + seed;
+    y = y * 1.0001 + x;
+    if (yield) {
+      lReschedule(exec);
+    }
+  }
+  return x + y;
+}
+
+static void worker(struct ExecBase *exec) {
+  long id;
+
+  id = (long) lFindTask(exec)->user;
+  result[id] = series(exec, id + 1, 1);
+  lReleaseSemaphore(exec, &finished, 1);
+}
+
+#define STACK_SIZE 1024
+void test_fpu0(struct ExecBase *exec) {
+  double expect[NTASK + 1];
+  unsigned long tstart;
+  unsigned long t;
+
+  lInitSemaphore(exec, &finished, 0);
+  for (int i = 0; i <= NTASK; i++) {
+    expect[i] = series(exec, i + 1, 0);
+  }
+
+  tstart = lGetTimeStamp(exec);
+  for (long i = 0; i < NTASK; i++) {
+    struct Task *task;
+
+    task = lCreateTask(exec, "fpu", 0, worker, (void *) i, NULL,
+     STACK_SIZE);
+    vtest(task);
+  }
+  /* This task uses the FPU too while the others run. */
+  vtest(series(exec, NTASK + 1, 1) == expect[NTASK]);
+  for (int i = 0; i < NTASK; i++) {
+    lObtainSemaphore(exec, &finished);
+  }
+  t = lGetTimeStamp(exec) - tstart;
+  for (int i = 0; i < NTASK; i++) {
+    vtest(result[i] == expect[i]);
+  }
+  kprintf(exec, "fpu0: %lu ticks for %d steps with %d tasks\n",
+   t, NSTEP, NTASK + 1);
+}
+
@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* GetLatency() histograms of wakeups */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NROUND   = 100,
+  PRI      = 3,
+};
+
+static struct Semaphore ping;
+static struct Semaphore pong;
+
+static void ponger(struct ExecBase *exec) {
+  for (int i = 0; i < NROUND; i++) {
+    lObtainSemaphore(exec, &ping);
+    lReleaseSemaphore(exec, &pong, 1);
+  }
+}
+
+static void kputc(void *arg, int c) {
+  lRawPutChar((struct ExecBase *) arg, c);
+}
+
+#define STACK_SIZE 1024
+void test_latency0(struct ExecBase *exec) {
+  static struct LatencyStats ls;
+  unsigned long n;
+  int found;
+
+  lInitSemaphore(exec, &ping, 0);
+  lInitSemaphore(exec, &pong, 0);
+  lClearLatency(exec);
+  vtest(lCreateTask(exec, "latency0", PRI, ponger, NULL, NULL,
+   STACK_SIZE));
+  for (int i = 0; i < NROUND; i++) {
+    lReleaseSemaphore(exec, &ping, 1);
+    lObtainSemaphore(exec, &pong);
+  }
+
+  found = 0;
+  for (int i = 0; lGetLatency(exec, LAT_WAKEUP, i, &ls); i++) {
+    if (ls.pri != PRI) {
+      continue;
+    }
+    found = 1;
+    n = 0;
+    for (int k = 0; k < LAT_NBUCKET; k++) {
+      n += ls.bucket[k];
+    }
+    vtest(n == ls.n);
+    vtest(ls.n <= NROUND);
+  }
+  vtest(!lGetLatency(exec, LAT_IPI, 1, &ls));
+  if (!found) {
+    kprintf(exec, "latency0: no latency samples\n");
+    return;
+  }
+  lReportLatency(exec, kputc, exec);
+}
+
@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* LightTask chain and message port echo */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NLIGHT   = 200,
+  NROUND   = 10,
+  NMSG     = 100,
+  SIGB_TOKEN = 0,
+  SIGB_PORT  = 1,
+};
+
+#define SIGF_TOKEN (1U << SIGB_TOKEN)
+
+static struct LightTask chain[NLIGHT];
+static int count[NLIGHT];
+static struct Semaphore roundtrip;
+
+/* Pass the token to the next one, the last one tells the test. */
+static unsigned int pass(struct ExecBase *exec, struct LightTask *lt) {
+  LT_BEGIN(lt);
+  while (1) {
+    LT_WAIT(lt, SIGF_TOKEN);
+    vtest(lt->signals == SIGF_TOKEN);
+    count[lt - chain]++;
+    if (lt == &chain[NLIGHT - 1]) {
+      lReleaseSemaphore(exec, &roundtrip, 1);
+    } else {
+      lSignalLightTask(exec, lt + 1, SIGF_TOKEN);
+    }
+  }
+  LT_END(lt);
+}
+
+static struct MsgPort port;
+static int nreplied;
+
+static unsigned int echo(struct ExecBase *exec, struct LightTask *lt) {
+  struct Message *msg;
+
+  LT_BEGIN(lt);
+  while (nreplied < NMSG) {
+    LT_WAIT(lt, 1U << SIGB_PORT);
+    while ((msg = lGetMsg(exec, &port))) {
+      nreplied++;
+      lReplyMsg(exec, msg);
+    }
+    LT_YIELD(lt);
+  }
+  LT_END(lt);
+}
+
+void test_light0(struct ExecBase *exec) {
+  static struct LightTask echotask;
+  struct MsgPort *replyport;
+  struct Message msg;
+  unsigned long tstart;
+  unsigned long t;
+
+  lInitSemaphore(exec, &roundtrip, 0);
+  for (int i = 0; i < NLIGHT; i++) {
+    chain[i].code = pass;
+    lAddLightTask(exec, &chain[i]);
+  }
+  tstart = lGetTimeStamp(exec);
+  for (int r = 0; r < NROUND; r++) {
+    lSignalLightTask(exec, &chain[0], SIGF_TOKEN);
+    lObtainSemaphore(exec, &roundtrip);
+  }
+  t = lGetTimeStamp(exec) - tstart;
+  for (int i = 0; i < NLIGHT; i++) {
+    vtest(count[i] == NROUND);
+  }
+  kprintf(exec, "light0: %d tasks in %lu bytes, %lu ticks for %d "
+   "hops\n", NLIGHT, (unsigned long) sizeof chain, t,
+   NLIGHT * NROUND);
+
+  lNewList(exec, &port.inv.msglist);
+  lInitIntLock(exec, &port.inv.lock);
+  port.sigtask = NULL;
+  port.siglight = &echotask;
+  port.sigbit = SIGB_PORT;
+  echotask.code = echo;
+  lAddLightTask(exec, &echotask);
+
+  replyport = lCreateMsgPort(exec);
+  vtest(replyport);
+  msg.replyport = replyport;
+  for (int i = 0; i < NMSG; i++) {
+    lPutMsg(exec, &port, &msg);
+    lWaitMsg(exec, &msg);
+  }
+  vtest(nreplied == NMSG);
+  lDeleteMsgPort(exec, replyport);
+}
+
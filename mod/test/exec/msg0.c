@@ -2,6 +2,7 @@
 /* Copyright 2020-2022 Martin Åberg */
 
 #include "test.h"
+#include <exec/mutex.h>
 #define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
 
 static struct Task *inittask;
@@ -73,7 +74,91 @@ static void f1(struct ExecBase *exec) {
   p0 = NULL;
 }
 
+/*
+ * Contended throughput: NSENDER tasks keep NINFLIGHT messages
+ * each in flight to one port. The receiver replies them to the
+ * sender port which has the same mode.
+ */
+enum {
+  NSENDER    = 4,
+  NINFLIGHT  = 4,
+  NPERSENDER = 2000,
+};
+
+static struct MsgPort *sink;
+static struct Semaphore sendersdone;
+
+static void sender(struct ExecBase *exec) {
+  struct Message *msg;
+  struct MsgPort *rp;
+  unsigned int sent;
+  unsigned int done;
+
+  msg = lAllocMem(exec, NINFLIGHT * sizeof *msg,
+   MEMF_CLEAR | MEMF_ANY);
+  vtest(msg);
+  rp = lCreateMsgPort(exec);
+  vtest(rp);
+  rp->flags = sink->flags;
+  for (sent = 0; sent < NINFLIGHT; sent++) {
+    msg[sent].replyport = rp;
+    lPutMsg(exec, sink, &msg[sent]);
+  }
+  for (done = 0; done < NPERSENDER; done++) {
+    struct Message *m;
+
+    lWaitPort(exec, rp);
+    m = lGetMsg(exec, rp);
+    vtest(m && m->node.type == NT_REPLYMSG);
+    if (sent < NPERSENDER) {
+      lPutMsg(exec, sink, m);
+      sent++;
+    }
+  }
+  vtest(lGetMsg(exec, rp) == NULL);
+  lDeleteMsgPort(exec, rp);
+  lFreeMem(exec, msg, NINFLIGHT * sizeof *msg);
+  lReleaseSemaphore(exec, &sendersdone, 1);
+}
+
 #define STACK_SIZE 1024
+static void bench(struct ExecBase *exec, unsigned char flags) {
+  unsigned long tstart;
+  unsigned long tend;
+  unsigned int n;
+
+  sink = lCreateMsgPort(exec);
+  vtest(sink);
+  sink->flags = flags;
+  lInitSemaphore(exec, &sendersdone, 0);
+  tstart = lGetTimeStamp(exec);
+  for (int i = 0; i < NSENDER; i++) {
+    struct Task *task;
+
+    task = lCreateTask(exec, "sender", 1, sender, NULL, NULL,
+     STACK_SIZE);
+    vtest(task);
+  }
+  for (n = 0; n < NSENDER * NPERSENDER; ) {
+    struct Message *m;
+
+    lWaitPort(exec, sink);
+    while ((m = lGetMsg(exec, sink))) {
+      vtest(m->node.type == NT_MESSAGE);
+      lReplyMsg(exec, m);
+      n++;
+    }
+  }
+  for (int i = 0; i < NSENDER; i++) {
+    lObtainSemaphore(exec, &sendersdone);
+  }
+  tend = lGetTimeStamp(exec);
+  vtest(lGetMsg(exec, sink) == NULL);
+  lDeleteMsgPort(exec, sink);
+  kprintf(exec, "msg0: %s port: %lu ticks for %u messages\n",
+   flags & MPF_LOCKFREE ? "lock-free" : "locked", tend - tstart, n);
+}
+
 void test_msg0(struct ExecBase *exec) {
   inittask = lFindTask(exec);
   vtest(inittask);
@@ -87,5 +172,8 @@ void test_msg0(struct ExecBase *exec) {
   while (state != 2) {
     lWait(exec, SIGF_SINGLE);
   }
+
+  bench(exec, 0);
+  bench(exec, MPF_LOCKFREE);
 }
 
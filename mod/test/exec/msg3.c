@@ -0,0 +1,119 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/*
+ * Stress test for PutMsg() signal coalescing. The receivers wait
+ * directly on the port signal and then remove all messages, so a
+ * lost signal makes the test hang.
+ */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NSENDER = 4,
+  ROUNDS  = 500,
+  BURST   = 4,
+};
+
+static struct MsgPort *sink;
+static struct Semaphore sendersdone;
+
+/* Remove messages until n have been received. */
+static void collect(struct ExecBase *exec, struct MsgPort *port, int n) {
+  int got = 0;
+
+  while (got < n) {
+    lWait(exec, 1U << port->sigbit);
+    while (lGetMsg(exec, port)) {
+      got++;
+    }
+  }
+  vtest(got == n);
+}
+
+static void sender(struct ExecBase *exec) {
+  struct Message *msg;
+  struct MsgPort *rp;
+  struct List list;
+  int usewaitmsg;
+
+  usewaitmsg = *(int *) lFindTask(exec)->user;
+  rp = lCreateMsgPort(exec);
+  vtest(rp);
+  rp->flags = sink->flags;
+  /* BURST messages do not fit in a small stack frame. */
+  msg = lAllocMem(exec, BURST * sizeof *msg, MEMF_CLEAR | MEMF_ANY);
+  vtest(msg);
+  for (int i = 0; i < BURST; i++) {
+    msg[i].replyport = rp;
+  }
+  for (int r = 0; r < ROUNDS; r++) {
+    if (r & 1) {
+      lNewList(exec, &list);
+      for (int i = 0; i < BURST; i++) {
+        lAddTail(exec, &list, &msg[i].node);
+      }
+      lPutMsgs(exec, sink, &list);
+    } else {
+      for (int i = 0; i < BURST; i++) {
+        lPutMsg(exec, sink, &msg[i]);
+      }
+    }
+    if (usewaitmsg) {
+      /* replies arrive while waiting for another message */
+      for (int i = BURST - 1; 0 <= i; i--) {
+        lWaitMsg(exec, &msg[i]);
+      }
+    } else {
+      collect(exec, rp, BURST);
+    }
+  }
+  vtest(lGetMsg(exec, rp) == NULL);
+  lFreeMem(exec, msg, BURST * sizeof *msg);
+  lDeleteMsgPort(exec, rp);
+  lReleaseSemaphore(exec, &sendersdone, 1);
+}
+
+#define STACK_SIZE 1024
+static void stress(struct ExecBase *exec, unsigned char flags) {
+  static int usewaitmsg[NSENDER];
+  struct Message *m;
+  int n;
+
+  sink = lCreateMsgPort(exec);
+  vtest(sink);
+  sink->flags = flags;
+  lInitSemaphore(exec, &sendersdone, 0);
+  for (int i = 0; i < NSENDER; i++) {
+    struct Task *task;
+
+    usewaitmsg[i] = i & 1;
+    task = lCreateTask(exec, "sender", 1, sender, &usewaitmsg[i],
+     NULL, STACK_SIZE);
+    vtest(task);
+  }
+  for (n = 0; n < NSENDER * ROUNDS * BURST; ) {
+    lWait(exec, 1U << sink->sigbit);
+    while ((m = lGetMsg(exec, sink))) {
+      vtest(m->node.type == NT_MESSAGE);
+      lReplyMsg(exec, m);
+      n++;
+    }
+  }
+  for (int i = 0; i < NSENDER; i++) {
+    lObtainSemaphore(exec, &sendersdone);
+  }
+  vtest(lGetMsg(exec, sink) == NULL);
+  kprintf(exec, "msg3: %s port: %d messages, %u signals suppressed\n",
+   flags & MPF_LOCKFREE ? "lock-free" : "locked", n,
+   sink->suppressed);
+  lDeleteMsgPort(exec, sink);
+}
+
+void test_msg3(struct ExecBase *exec) {
+  stress(exec, 0);
+  stress(exec, MPF_LOCKFREE);
+}
+
@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Mutex in shared and exclusive mode */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NITEM    = 1000,
+  NREADER  = 2,
+};
+
+#define UNSET (~0U)
+
+static struct Mutex mutex;
+static struct Semaphore finished;
+static unsigned int item[NITEM];
+static unsigned int nitem;
+
+/* Append 0, 1, ... in exclusive mode. */
+static void producer(struct ExecBase *exec) {
+  for (unsigned int i = 0; i < NITEM; i++) {
+    lObtainMutex(exec, &mutex);
+    item[nitem++] = UNSET;
+    /* Readers shall not see the half written item. */
+    lYield(exec);
+    item[nitem - 1] = i;
+    lReleaseMutex(exec, &mutex);
+    lYield(exec);
+  }
+  lReleaseSemaphore(exec, &finished, 1);
+}
+
+/* Check in shared mode that all items arrive in order. */
+static void consumer(struct ExecBase *exec) {
+  unsigned int seen;
+
+  seen = 0;
+  while (seen < NITEM) {
+    lObtainMutexShared(exec, &mutex);
+    vtest(seen <= nitem);
+    for (; seen < nitem; seen++) {
+      vtest(item[seen] == seen);
+    }
+    lReleaseMutex(exec, &mutex);
+    lYield(exec);
+  }
+  lReleaseSemaphore(exec, &finished, 1);
+}
+
+static void test_nest(struct ExecBase *exec) {
+  struct Mutex m;
+
+  lInitMutex(exec, &m);
+  lObtainMutexShared(exec, &m);
+  vtest(m.owner == NULL && m.shared == 1);
+  lReleaseMutex(exec, &m);
+  vtest(m.owner == NULL && m.shared == 0);
+
+  lObtainMutex(exec, &m);
+  vtest(m.owner == lFindTask(exec));
+  /* shared while holding exclusive nests */
+  lObtainMutexShared(exec, &m);
+  vtest(m.shared == 0 && m.nest == 1);
+  lReleaseMutex(exec, &m);
+  lReleaseMutex(exec, &m);
+  vtest(m.owner == NULL && m.nest == 0);
+}
+
+#define STACK_SIZE 1024
+void test_mutex0(struct ExecBase *exec) {
+  struct Task *task;
+  int pri;
+
+  test_nest(exec);
+
+  lInitMutex(exec, &mutex);
+  lInitSemaphore(exec, &finished, 0);
+  pri = lFindTask(exec)->node.pri;
+  for (int i = 0; i < NREADER; i++) {
+    task = lCreateTask(exec, "consumer", pri, consumer, NULL, NULL,
+     STACK_SIZE);
+    vtest(task);
+  }
+  task = lCreateTask(exec, "producer", pri, producer, NULL, NULL,
+   STACK_SIZE);
+  vtest(task);
+  for (int i = 0; i < NREADER + 1; i++) {
+    lObtainSemaphore(exec, &finished);
+  }
+  vtest(nitem == NITEM);
+  vtest(mutex.owner == NULL && mutex.shared == 0);
+}
+
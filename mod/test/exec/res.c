@@ -33,6 +33,51 @@ static int init2(struct ExecBase *exec, void *data,
   info("%s: test_msg2\n", __func__);
   test_msg2(exec);
 
+  info("%s: test_msg3\n", __func__);
+  test_msg3(exec);
+
+  info("%s: test_mutex0\n", __func__);
+  test_mutex0(exec);
+
+  info("%s: test_ring0\n", __func__);
+  test_ring0(exec);
+
+  info("%s: test_sync0\n", __func__);
+  test_sync0(exec);
+
+  info("%s: test_barrier0\n", __func__);
+  test_barrier0(exec);
+
+  info("%s: test_forkjoin0\n", __func__);
+  test_forkjoin0(exec);
+
+  info("%s: test_work0\n", __func__);
+  test_work0(exec);
+
+  info("%s: test_fpu0\n", __func__);
+  test_fpu0(exec);
+
+  info("%s: test_taskcache0\n", __func__);
+  test_taskcache0(exec);
+
+  info("%s: test_stack0\n", __func__);
+  test_stack0(exec);
+
+  info("%s: test_light0\n", __func__);
+  test_light0(exec);
+
+  info("%s: test_co0\n", __func__);
+  test_co0(exec);
+
+  info("%s: test_yield0\n", __func__);
+  test_yield0(exec);
+
+  info("%s: test_taskstats0\n", __func__);
+  test_taskstats0(exec);
+
+  info("%s: test_latency0\n", __func__);
+  test_latency0(exec);
+
   info("%s: done\n", __func__);
 
   return 0;
@@ -0,0 +1,131 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Ring channel test, throughput and latency benchmarks */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NREC     = 64,
+  BATCH    = 16,
+  NSTREAM  = 20000,
+  NPING    = 1000,
+};
+
+struct record {
+  unsigned int seq;
+  unsigned long stamp;
+};
+
+static struct Ring *ring;
+static struct Ring *echoring;
+static struct Semaphore ready;
+static struct Semaphore finish;
+
+static struct record *reserve(struct ExecBase *exec, struct Ring *r) {
+  struct record *rec;
+
+  while ((rec = lReserveRing(exec, r)) == NULL) {
+    lCommitRing(exec, r);
+    lWaitRingSpace(exec, r);
+  }
+  return rec;
+}
+
+static struct record *readone(struct ExecBase *exec, struct Ring *r) {
+  struct record *rec;
+
+  while ((rec = lReadRing(exec, r)) == NULL) {
+    lWaitRing(exec, r);
+  }
+  return rec;
+}
+
+static void producer(struct ExecBase *exec) {
+  for (unsigned int i = 0; i < NSTREAM; i++) {
+    reserve(exec, ring)->seq = i;
+    if (i % BATCH == BATCH - 1) {
+      lCommitRing(exec, ring);
+    }
+  }
+  lCommitRing(exec, ring);
+  lReleaseSemaphore(exec, &ready, 1);
+}
+
+/* Consumer of echoring, producer of ring. */
+static void echo(struct ExecBase *exec) {
+  echoring = lCreateRing(exec, NREC, sizeof (struct record));
+  vtest(echoring);
+  lReleaseSemaphore(exec, &ready, 1);
+  for (unsigned int i = 0; i < NPING; i++) {
+    struct record *in;
+    struct record *out;
+
+    in = readone(exec, echoring);
+    out = reserve(exec, ring);
+    *out = *in;
+    lReleaseRing(exec, echoring);
+    lCommitRing(exec, ring);
+  }
+  /* The producer may still be in CommitRing(). */
+  lObtainSemaphore(exec, &finish);
+  lDeleteRing(exec, echoring);
+  lReleaseSemaphore(exec, &ready, 1);
+}
+
+#define STACK_SIZE 1024
+void test_ring0(struct ExecBase *exec) {
+  struct Task *task;
+  struct record *rec;
+  unsigned long tstart;
+  unsigned long total;
+
+  lInitSemaphore(exec, &ready, 0);
+  lInitSemaphore(exec, &finish, 0);
+  ring = lCreateRing(exec, NREC - 1, sizeof (struct record));
+  vtest(ring);
+  vtest(ring->mask == NREC - 1);
+
+  /* throughput */
+  tstart = lGetTimeStamp(exec);
+  task = lCreateTask(exec, "producer", 1, producer, NULL, NULL,
+   STACK_SIZE);
+  vtest(task);
+  for (unsigned int i = 0; i < NSTREAM; i++) {
+    rec = readone(exec, ring);
+    vtest(rec->seq == i);
+    if (i % BATCH == BATCH - 1) {
+      lReleaseRing(exec, ring);
+    }
+  }
+  lReleaseRing(exec, ring);
+  total = lGetTimeStamp(exec) - tstart;
+  lObtainSemaphore(exec, &ready);
+  vtest(lReadRing(exec, ring) == NULL);
+  kprintf(exec, "ring0: stream: %lu ticks for %d records\n",
+   total, NSTREAM);
+
+  /* latency */
+  task = lCreateTask(exec, "echo", 1, echo, NULL, NULL, STACK_SIZE);
+  vtest(task);
+  lObtainSemaphore(exec, &ready);
+  total = 0;
+  for (unsigned int i = 0; i < NPING; i++) {
+    rec = reserve(exec, echoring);
+    rec->seq = i;
+    rec->stamp = lGetTimeStamp(exec);
+    lCommitRing(exec, echoring);
+    rec = readone(exec, ring);
+    vtest(rec->seq == i);
+    total += lGetTimeStamp(exec) - rec->stamp;
+    lReleaseRing(exec, ring);
+  }
+  lReleaseSemaphore(exec, &finish, 1);
+  lObtainSemaphore(exec, &ready);
+  kprintf(exec, "ring0: ping-pong: %lu ticks for %d round trips\n",
+   total, NPING);
+  lDeleteRing(exec, ring);
+}
+
@@ -0,0 +1,99 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* GetStackUsage() and a stack report of the existing tasks */
+
+#include "test.h"
+#include <exec/execbase.h>
+#include <exec/mutex.h>
+#include <exec/tasks.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NREPORT  = 32,
+  DEPTH    = 600,
+  CHUNK    = 64,
+};
+
+static struct Semaphore used;
+static struct Semaphore leave;
+
+/*
+ * Touch at least depth bytes below the caller's frame, with one
+ * small frame per CHUNK bytes.
+ */
+static int deep(struct ExecBase *exec, int depth) {
+  volatile char buf[CHUNK];
+  int ret;
+
+  for (int i = 0; i < CHUNK; i++) {
+    buf[i] = i;
+  }
+  ret = 0;
+  if (CHUNK < depth) {
+    ret = deep(exec, depth - CHUNK);
+  }
+  /* buf is read after the call, so it is no tail call */
+  return ret + buf[0];
+}
+
+static void user(struct ExecBase *exec) {
+  vtest(deep(exec, DEPTH) == 0);
+  lReleaseSemaphore(exec, &used, 1);
+  lObtainSemaphore(exec, &leave);
+}
+
+static void report(struct ExecBase *exec) {
+  static struct {
+    const char *name;
+    size_t used;
+    size_t size;
+  } r[NREPORT];
+  struct List *lists[2];
+  int n;
+
+  lists[0] = &exec->taskready;
+  lists[1] = &exec->taskwait;
+  n = 0;
+  lObtainIntLock(exec, &exec->tasklock);
+  for (int i = 0; i < 2; i++) {
+    for (struct Node *node = lists[i]->head;
+     node->succ && n < NREPORT; node = node->succ) {
+      struct Task *task = (struct Task *) node;
+
+      r[n].name = task->node.name;
+      r[n].used = lGetStackUsage(exec, task);
+      r[n].size = (char *) task->spupper - (char *) task->splower;
+      n++;
+    }
+  }
+  lReleaseIntLock(exec, &exec->tasklock);
+  for (int i = 0; i < n; i++) {
+    kprintf(exec, "stack0: %-10s %6lu of %6lu bytes\n", r[i].name,
+     (unsigned long) r[i].used, (unsigned long) r[i].size);
+  }
+}
+
+#define STACK_SIZE 2048
+void test_stack0(struct ExecBase *exec) {
+  struct Task *task;
+  size_t size;
+  size_t n;
+
+  lInitSemaphore(exec, &used, 0);
+  lInitSemaphore(exec, &leave, 0);
+  task = lCreateTask(exec, "stack0", 1, user, NULL, NULL, STACK_SIZE);
+  vtest(task);
+  lObtainSemaphore(exec, &used);
+  n = lGetStackUsage(exec, task);
+  size = (char *) task->spupper - (char *) task->splower;
+  if (n == 0) {
+    kprintf(exec, "stack0: stacks not painted\n");
+  } else {
+    vtest(DEPTH <= n);
+    vtest(n <= size);
+    report(exec);
+  }
+  lReleaseSemaphore(exec, &leave, 1);
+}
+
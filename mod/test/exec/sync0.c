@@ -0,0 +1,131 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Semaphore, Condition, EventFlags and WaitAddress() */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  ROUNDS   = 1234,
+  NSLOTS   = 4,
+  NWAITERS = 3,
+  NMUTEX   = 1000,
+};
+
+#define EV_PRODUCER (1U << 0)
+#define EV_CONSUMER (1U << 1)
+#define EV_WAITER0  (1U << 2)
+#define EV_ALLDONE  ((EV_WAITER0 << NWAITERS) - 1)
+
+static struct Semaphore freeslots;
+static struct Semaphore usedslots;
+static unsigned int ring[NSLOTS];
+static struct Mutex mutex;
+static struct Condition cond;
+static int go;
+static int nwoken;
+static struct EventFlags done;
+static unsigned int waiterbit[NWAITERS];
+static volatile unsigned int word;
+
+static void producer(struct ExecBase *exec) {
+  for (unsigned int i = 0; i < ROUNDS; i++) {
+    lObtainSemaphore(exec, &freeslots);
+    ring[i % NSLOTS] = i;
+    lReleaseSemaphore(exec, &usedslots, 1);
+  }
+  lSetEventFlags(exec, &done, EV_PRODUCER);
+}
+
+static void consumer(struct ExecBase *exec) {
+  for (unsigned int i = 0; i < ROUNDS; i++) {
+    lObtainSemaphore(exec, &usedslots);
+    vtest(ring[i % NSLOTS] == i);
+    lReleaseSemaphore(exec, &freeslots, 1);
+  }
+  lSetEventFlags(exec, &done, EV_CONSUMER);
+}
+
+static void waiter(struct ExecBase *exec) {
+  unsigned int *bit = lFindTask(exec)->user;
+
+  lObtainMutex(exec, &mutex);
+  while (!go) {
+    lWaitCondition(exec, &cond, &mutex);
+  }
+  nwoken++;
+  lReleaseMutex(exec, &mutex);
+  lSetEventFlags(exec, &done, *bit);
+}
+
+static void addrwaiter(struct ExecBase *exec) {
+  while (word == 0) {
+    lWaitAddress(exec, &word, 0);
+  }
+  lSetEventFlags(exec, &done, EV_PRODUCER);
+}
+
+#define STACK_SIZE 1024
+void test_sync0(struct ExecBase *exec) {
+  struct Task *task;
+  unsigned int flags;
+  unsigned long tstart;
+
+  lInitSemaphore(exec, &freeslots, NSLOTS);
+  lInitSemaphore(exec, &usedslots, 0);
+  lInitMutex(exec, &mutex);
+  lInitCondition(exec, &cond);
+  lInitEventFlags(exec, &done, 0);
+
+  vtest(lAttemptSemaphore(exec, &usedslots) == 0);
+  /* satisfied without waiting */
+  lSetEventFlags(exec, &done, EV_PRODUCER);
+  flags = lWaitEventFlags(exec, &done, EV_PRODUCER, EVF_CLEAR);
+  vtest(flags == EV_PRODUCER);
+
+  for (int i = 0; i < NWAITERS; i++) {
+    waiterbit[i] = EV_WAITER0 << i;
+    task = lCreateTask(exec, "waiter", 1, waiter, &waiterbit[i],
+     NULL, STACK_SIZE);
+    vtest(task);
+  }
+  task = lCreateTask(exec, "consumer", 1, consumer, NULL, NULL,
+   STACK_SIZE);
+  vtest(task);
+  task = lCreateTask(exec, "producer", 1, producer, NULL, NULL,
+   STACK_SIZE);
+  vtest(task);
+
+  lObtainMutex(exec, &mutex);
+  go = 1;
+  lBroadcastCondition(exec, &cond);
+  lReleaseMutex(exec, &mutex);
+
+  flags = lWaitEventFlags(exec, &done, EV_ALLDONE, EVF_ALL | EVF_CLEAR);
+  vtest((flags & EV_ALLDONE) == EV_ALLDONE);
+  vtest(lClearEventFlags(exec, &done, 0) == 0);
+  vtest(nwoken == NWAITERS);
+  vtest(freeslots.count == NSLOTS);
+  vtest(usedslots.count == 0);
+
+  word = 0;
+  vtest(lWaitAddress(exec, &word, 1) == 0);
+  task = lCreateTask(exec, "addrwaiter", 1, addrwaiter, NULL, NULL,
+   STACK_SIZE);
+  vtest(task);
+  word = 1;
+  lWakeAddress(exec, &word, 1);
+  lWaitEventFlags(exec, &done, EV_PRODUCER, EVF_CLEAR);
+
+  /* uncontended pair */
+  tstart = lGetTimeStamp(exec);
+  for (int i = 0; i < NMUTEX; i++) {
+    lObtainMutex(exec, &mutex);
+    lReleaseMutex(exec, &mutex);
+  }
+  kprintf(exec, "sync0: %lu ticks for %d ObtainMutex/ReleaseMutex\n",
+   lGetTimeStamp(exec) - tstart, NMUTEX);
+}
+
@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* CreateTask() reuse of ended tasks and create/end throughput */
+
+#include "test.h"
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NTASK    = 200,
+};
+
+static int nrun;
+
+static void child(struct ExecBase *exec) {
+  nrun++;
+}
+
+/*
+ * The Message is replied by the cleanup after the Task and stack
+ * have been handed back, so they are in the cache when we return.
+ */
+static struct Task *runchild(struct ExecBase *exec,
+ struct MsgPort *port, size_t stacksize) {
+  struct Message msg;
+  struct List cleanup;
+  struct Task *task;
+
+  lNewList(exec, &cleanup);
+  msg.replyport = port;
+  msg.node.type = NT_MESSAGE;
+  lAddTail(exec, &cleanup, &msg.node);
+  task = lCreateTask(exec, "child", 1, child, NULL, &cleanup,
+   stacksize);
+  vtest(task);
+  lWaitMsg(exec, &msg);
+  return task;
+}
+
+/* Not used by other tests, so nobody else takes it from the cache. */
+#define STACK_SIZE 3072
+void test_taskcache0(struct ExecBase *exec) {
+  struct MsgPort *port;
+  struct Task *first;
+  unsigned long tstart;
+  unsigned long t;
+  size_t avail;
+
+  port = lCreateMsgPort(exec);
+  vtest(port);
+  nrun = 0;
+
+  tstart = lGetTimeStamp(exec);
+  first = runchild(exec, port, STACK_SIZE);
+  t = lGetTimeStamp(exec) - tstart;
+  kprintf(exec, "taskcache0: %lu ticks for the first task\n", t);
+
+  tstart = lGetTimeStamp(exec);
+  for (int i = 0; i < NTASK; i++) {
+    vtest(runchild(exec, port, STACK_SIZE) == first);
+  }
+  t = lGetTimeStamp(exec) - tstart;
+  vtest(nrun == NTASK + 1);
+  kprintf(exec, "taskcache0: %lu ticks for %d recycled tasks\n",
+   t, NTASK);
+
+  /* A failing AllocMem() gives the cached tasks back. */
+  avail = lAvailMem(exec, MEMF_ANY);
+  vtest(lAllocMem(exec, ~(size_t) 0 / 2, MEMF_ANY) == NULL);
+  vtest(avail + STACK_SIZE <= lAvailMem(exec, MEMF_ANY));
+  lDeleteMsgPort(exec, port);
+}
+
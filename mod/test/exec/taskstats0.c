@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* GetTaskStats() and ReportTaskStats() */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NWAIT    = 20,
+  NSPIN    = 20000,
+};
+
+static struct Semaphore go;
+static struct Semaphore done;
+static volatile unsigned long sink;
+
+static void worker(struct ExecBase *exec) {
+  for (int i = 0; i < NWAIT; i++) {
+    lObtainSemaphore(exec, &go);
+    for (int k = 0; k < NSPIN; k++) {
+      sink += k;
+    }
+    lReleaseSemaphore(exec, &done, 1);
+  }
+  lObtainSemaphore(exec, &go);
+}
+
+static void kputc(void *arg, int c) {
+  lRawPutChar((struct ExecBase *) arg, c);
+}
+
+#define STACK_SIZE 1024
+void test_taskstats0(struct ExecBase *exec) {
+  struct TaskStats s;
+  struct Task *task;
+  unsigned long t;
+
+  lInitSemaphore(exec, &go, 0);
+  lInitSemaphore(exec, &done, 0);
+  task = lCreateTask(exec, "stats0", 1, worker, NULL, NULL,
+   STACK_SIZE);
+  vtest(task);
+
+  t = lGetTimeStamp(exec);
+  for (int i = 0; i < NWAIT; i++) {
+    lReleaseSemaphore(exec, &go, 1);
+    lObtainSemaphore(exec, &done);
+  }
+  t = lGetTimeStamp(exec) - t;
+  lGetTaskStats(exec, task, &s);
+  if (s.nswitch == 0) {
+    kprintf(exec, "taskstats0: no task statistics\n");
+  } else {
+    /* switched out at most as many times as in */
+    vtest(1 <= s.nvoluntary);
+    vtest(s.nvoluntary + s.ninvoluntary <= s.nswitch);
+    vtest(t == 0 || s.runtime != 0);
+    kprintf(exec, "taskstats0: %lu switches, run %lu ready %lu\n",
+     s.nswitch, (unsigned long) s.runtime,
+     (unsigned long) s.readytime);
+    lReportTaskStats(exec, kputc, exec);
+  }
+  lReleaseSemaphore(exec, &go, 1);
+}
+
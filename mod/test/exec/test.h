@@ -5,9 +5,24 @@
 #include <exec/libcall.h>
 
 void test_xyz(struct ExecBase *exec);
+void test_barrier0(struct ExecBase *exec);
+void test_co0(struct ExecBase *exec);
+void test_forkjoin0(struct ExecBase *exec);
+void test_fpu0(struct ExecBase *exec);
+void test_latency0(struct ExecBase *exec);
+void test_light0(struct ExecBase *exec);
 void test_list0(struct ExecBase *exec);
 void test_msg0(struct ExecBase *exec);
 void test_msg2(struct ExecBase *exec);
+void test_msg3(struct ExecBase *exec);
+void test_mutex0(struct ExecBase *exec);
+void test_ring0(struct ExecBase *exec);
+void test_stack0(struct ExecBase *exec);
+void test_sync0(struct ExecBase *exec);
+void test_taskcache0(struct ExecBase *exec);
+void test_taskstats0(struct ExecBase *exec);
+void test_work0(struct ExecBase *exec);
+void test_yield0(struct ExecBase *exec);
 
 void kprintf(struct ExecBase *exec, const char *fmt, ...);
 
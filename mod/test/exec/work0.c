@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* QueueWork() and CancelWork() */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NREPEAT  = 100,
+};
+
+static struct Semaphore started;
+static struct Semaphore gate;
+static struct Semaphore finished;
+static struct Work *order[2];
+static int norder;
+static volatile int blockerdone;
+static int nrepeat;
+
+/* Keeps the worker of CPU 0 busy until the gate opens. */
+static void blocker(struct ExecBase *exec, struct Work *work) {
+  lReleaseSemaphore(exec, &started, 1);
+  lObtainSemaphore(exec, &gate);
+  blockerdone = 1;
+}
+
+static void record(struct ExecBase *exec, struct Work *work) {
+  order[norder++] = work;
+  lReleaseSemaphore(exec, &finished, 1);
+}
+
+static void repeat(struct ExecBase *exec, struct Work *work) {
+  nrepeat++;
+  if (nrepeat == NREPEAT) {
+    lReleaseSemaphore(exec, &finished, 1);
+    return;
+  }
+  /* Off the queue while running, so it can be queued again. */
+  vtest(lQueueWork(exec, work, nrepeat) == 1);
+}
+
+static void opener(struct ExecBase *exec) {
+  lReleaseSemaphore(exec, &gate, 1);
+}
+
+#define STACK_SIZE 1024
+void test_work0(struct ExecBase *exec) {
+  static struct Work block;
+  static struct Work a;
+  static struct Work b;
+  static struct Work rep;
+  struct Task *task;
+
+  lInitSemaphore(exec, &started, 0);
+  lInitSemaphore(exec, &gate, 0);
+  lInitSemaphore(exec, &finished, 0);
+  block.code = blocker;
+  a.code = record;
+  b.code = record;
+  rep.code = repeat;
+
+  vtest(lQueueWork(exec, &block, 0) == 1);
+  lObtainSemaphore(exec, &started);
+
+  /* The worker is busy, so the items stay queued. */
+  vtest(lQueueWork(exec, &a, 0) == 1);
+  vtest(lQueueWork(exec, &a, 0) == 0);
+  vtest(lCancelWork(exec, &a) == 1);
+  vtest(lCancelWork(exec, &a) == 0);
+  vtest(lQueueWork(exec, &b, 0) == 1);
+  vtest(lQueueWork(exec, &a, 0) == 1);
+
+  /* Runs when we wait for the blocker to finish. */
+  task = lCreateTask(exec, "opener", 0, opener, NULL, NULL,
+   STACK_SIZE);
+  vtest(task);
+  vtest(lCancelWork(exec, &block) == 0);
+  vtest(blockerdone);
+
+  lObtainSemaphore(exec, &finished);
+  lObtainSemaphore(exec, &finished);
+  vtest(norder == 2);
+  vtest(order[0] == &b);
+  vtest(order[1] == &a);
+
+  vtest(lQueueWork(exec, &rep, WORK_ANYCPU) == 1);
+  lObtainSemaphore(exec, &finished);
+  vtest(nrepeat == NREPEAT);
+}
+
@@ -2,6 +2,7 @@
 /* Copyright 2020-2022 Martin Åberg */
 
 #include "test.h"
+#include <exec/atomic.h>
 #define KASSERT(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
 
 /*
@@ -54,14 +55,224 @@ static const struct Resident lib0res = {
   .init.iauto.possize     = sizeof (struct MyLibrary),
 };
 
+struct rcutest {
+  struct RCUHead head;
+  struct Task *task;
+  int sigbit;
+};
+
+static void rcudone(struct ExecBase *exec, struct RCUHead *head) {
+  struct rcutest *t = (struct rcutest *) head;
+  lSignal(exec, t->task, 1U << t->sigbit);
+}
+
+static volatile int softran[3];
+static volatile int nsoftran;
+
+static void softcode(struct ExecBase *exec, void *data) {
+  softran[nsoftran++] = *(int *) data;
+}
+
+/* intnum 0 is reserved, or a timer which the tests do not start */
+enum {
+  INTTHREAD_INTNUM  = 0,
+  INTTHREAD_STACK   = 1024,
+};
+
+static struct IntThread intthread;
+static struct Semaphore intgo;
+static struct Task *volatile intthreadtask;
+static volatile int nintcode;
+static volatile int intnest;
+
+/* Waits for intgo so that the test can interrupt it. */
+static void intcode(struct ExecBase *exec, void *data) {
+  KASSERT(data == &intthread);
+  KASSERT(lFindTask(exec) == intthreadtask);
+  KASSERT(intnest++ == 0);
+  nintcode++;
+  lObtainSemaphore(exec, &intgo);
+  intnest--;
+}
+
+/* Run the short server the way the interrupt handler does. */
+static void intfire(struct ExecBase *exec) {
+  struct IntLock lock;
+
+  lInitIntLock(exec, &lock);
+  lObtainIntLock(exec, &lock);
+  intthread.server.code(exec, intthread.server.data);
+  lReleaseIntLock(exec, &lock);
+}
+
+static void test_atomic(struct ExecBase *exec) {
+  volatile AtomicInteger a = 5;
+  void *volatile ptr = NULL;
+
+  KASSERT(lAtomicCompareSwap(exec, &a, 4, 7) == 5 && a == 5);
+  KASSERT(lAtomicCompareSwap(exec, &a, 5, 7) == 5 && a == 7);
+  KASSERT(lAtomicSwap(exec, &a, 1) == 7 && a == 1);
+  KASSERT(lAtomicAdd(exec, &a, 2) == 1 && a == 3);
+  KASSERT(lAtomicAnd(exec, &a, 2) == 3 && a == 2);
+  KASSERT(lAtomicOr(exec, &a, 5) == 2 && a == 7);
+  KASSERT(atomic_add(exec, &a, 1) == 7 && a == 8);
+  KASSERT(lAtomicCompareSwapPtr(exec, &ptr, NULL, exec) == NULL);
+  KASSERT(atomic_swap_ptr(exec, &ptr, NULL) == exec && ptr == NULL);
+  lAtomicFence(exec);
+}
+
+static void test_rcu(struct ExecBase *exec) {
+  struct rcutest t;
+  struct Node *node;
+
+  lObtainRCU(exec);
+  lObtainRCU(exec);
+  node = lFindName(exec, &exec->liblist, "exec.library");
+  KASSERT(node == &exec->lib.node);
+  lReleaseRCU(exec);
+  lReleaseRCU(exec);
+  lSyncRCU(exec);
+
+  t.task = lFindTask(exec);
+  t.sigbit = lAllocSignal(exec, -1);
+  KASSERT(0 <= t.sigbit);
+  lCallRCU(exec, &t.head, rcudone);
+  lWait(exec, 1U << t.sigbit);
+  lFreeSignal(exec, t.sigbit);
+}
+
+static void test_brlock(struct ExecBase *exec) {
+  struct BRLock *lock;
+
+  lock = lCreateBRLock(exec);
+  KASSERT(lock);
+  lObtainBRLockShared(exec, lock);
+  lObtainBRLockShared(exec, lock);
+  KASSERT(lock->writer == 0 || lock->ncpu == 1);
+  lReleaseBRLock(exec, lock);
+  lReleaseBRLock(exec, lock);
+  lObtainBRLock(exec, lock);
+  KASSERT(lock->writer);
+  lReleaseBRLock(exec, lock);
+  KASSERT(lock->writer == 0);
+  lDeleteBRLock(exec, lock);
+  lDeleteBRLock(exec, NULL);
+}
+
+static void test_msglist(struct ExecBase *exec) {
+  for (int lockfree = 0; lockfree < 2; lockfree++) {
+    static struct Message msg[3];
+    struct MsgPort *port;
+    struct List list;
+    struct Node *node;
+    int i;
+
+    port = lCreateMsgPort(exec);
+    KASSERT(port);
+    port->flags = lockfree ? MPF_LOCKFREE : 0;
+    lNewList(exec, &list);
+    KASSERT(lGetMsgList(exec, port, &list) == 0);
+    for (i = 0; i < 3; i++) {
+      lAddTail(exec, &list, &msg[i].node);
+    }
+    lPutMsgs(exec, port, &list);
+    KASSERT(lGetHead(exec, &list) == NULL);
+    KASSERT(lGetMsg(exec, port) == &msg[0]);
+    KASSERT(lGetMsgList(exec, port, &list) == 1);
+    KASSERT(lGetMsg(exec, port) == NULL);
+    i = 1;
+    for (node = list.head; node->succ; node = node->succ) {
+      KASSERT(node == &msg[i].node);
+      KASSERT(node->type == NT_MESSAGE);
+      i++;
+    }
+    KASSERT(i == 3);
+    lDeleteMsgPort(exec, port);
+  }
+}
+
+static void test_softint(struct ExecBase *exec) {
+  static int id[2] = { 0, 1 };
+  static struct Interrupt soft[2];
+  struct IntLock lock;
+
+  for (int i = 0; i < 2; i++) {
+    soft[i].node.pri = i * 16;
+    soft[i].node.type = NT_INTERRUPT;
+    soft[i].data = &id[i];
+    soft[i].code = softcode;
+  }
+  lInitIntLock(exec, &lock);
+  /* queued with interrupts disabled, run by priority */
+  lObtainIntLock(exec, &lock);
+  lCause(exec, &soft[0]);
+  lCause(exec, &soft[1]);
+  lCause(exec, &soft[0]);
+  KASSERT(soft[0].node.type == NT_SOFTINT);
+  lReleaseIntLock(exec, &lock);
+  while (nsoftran < 2) {
+    ;
+  }
+  KASSERT(softran[0] == 1 && softran[1] == 0);
+  KASSERT(soft[0].node.type == NT_INTERRUPT);
+}
+
+/*
+ * An interrupt while the handler runs is held as pending, the
+ * source being masked, and handled once the handler has returned
+ * and unmasked it. RemIntThread() handles a pending interrupt
+ * before the task ends.
+ */
+static void test_intthread(struct ExecBase *exec) {
+  struct Task *task;
+
+  lInitSemaphore(exec, &intgo, 0);
+  intthread.interrupt.node.name = "intthread";
+  intthread.interrupt.code = intcode;
+  intthread.interrupt.data = &intthread;
+  task = lAddIntThread(exec, &intthread, INTTHREAD_INTNUM,
+   lFindTask(exec)->node.pri + 1, INTTHREAD_STACK);
+  KASSERT(task);
+  intthreadtask = task;
+  KASSERT(intthread.server.node.type == NT_INTERRUPT);
+
+  intfire(exec);
+  while (nintcode < 1) {
+    ;
+  }
+  intfire(exec);
+  KASSERT(intthread.pending);
+  KASSERT(nintcode == 1);
+  lReleaseSemaphore(exec, &intgo, 1);
+  while (nintcode < 2) {
+    ;
+  }
+  KASSERT(!intthread.pending);
+  lReleaseSemaphore(exec, &intgo, 1);
+  while (intnest) {
+    ;
+  }
+  KASSERT(nintcode == 2);
+
+  lReleaseSemaphore(exec, &intgo, 1);
+  intfire(exec);
+  lRemIntThread(exec, &intthread);
+  KASSERT(nintcode == 3);
+  KASSERT(intnest == 0);
+  KASSERT(!intthread.pending);
+}
+
 void test_xyz(struct ExecBase *exec) {
   {
     struct Node *node;
-    lObtainMutex(exec, &exec->devlock);
+    lObtainMutexShared(exec, &exec->devlock);
     node = lFindName(exec, &exec->devlist, "hej");
     lReleaseMutex(exec, &exec->devlock);
     KASSERT(node == NULL);
   }
+  test_atomic(exec);
+  test_rcu(exec);
+  test_brlock(exec);
   {
     void *p;
     size_t sz = 1024+1;
@@ -110,6 +321,9 @@ void test_xyz(struct ExecBase *exec) {
     lDeleteIORequest(exec, ior);
     lDeleteMsgPort(exec, port);
   }
+  test_msglist(exec);
+  test_softint(exec);
+  test_intthread(exec);
   {
     struct Library *mybase;
 
@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright 2022 Martin Åberg */
+
+/* Yield() among tasks of the same priority */
+
+#include "test.h"
+#include <exec/mutex.h>
+#define vtest(cond) if (!(cond)) lAlert(exec, AT_DeadEnd | __LINE__)
+
+enum {
+  NTASK    = 4,
+  NSTEP    = 500,
+};
+
+static struct Semaphore finished;
+static int step[NTASK];
+static int ncpu;
+
+static void worker(struct ExecBase *exec) {
+  long id;
+
+  id = (long) lFindTask(exec)->user;
+  for (int i = 0; i < NSTEP; i++) {
+    step[id]++;
+    /* One CPU runs the peers round robin. */
+    for (int j = 0; ncpu == 1 && j < NTASK; j++) {
+      vtest(step[id] - 1 <= step[j] && step[j] <= step[id]);
+    }
+    lYield(exec);
+  }
+  lReleaseSemaphore(exec, &finished, 1);
+}
+
+#define STACK_SIZE 1024
+void test_yield0(struct ExecBase *exec) {
+  unsigned long tstart;
+  unsigned long tyield;
+  unsigned long tswitch;
+  unsigned long t;
+  int pri;
+
+  lInitSemaphore(exec, &finished, 0);
+  ncpu = lGetCPUCount(exec);
+  pri = lFindTask(exec)->node.pri;
+
+  /* No peers: neither call switches. */
+  tstart = lGetTimeStamp(exec);
+  for (int i = 0; i < NSTEP; i++) {
+    lYield(exec);
+  }
+  tyield = lGetTimeStamp(exec) - tstart;
+  tstart = lGetTimeStamp(exec);
+  for (int i = 0; i < NSTEP; i++) {
+    lSwitch(exec);
+  }
+  tswitch = lGetTimeStamp(exec) - tstart;
+  kprintf(exec, "yield0: alone %lu ticks for %d Yield(), "
+   "%lu ticks for %d Switch()\n", tyield, NSTEP, tswitch, NSTEP);
+
+  for (long i = 0; i < NTASK; i++) {
+    struct Task *task;
+
+    task = lCreateTask(exec, "yield", pri, worker, (void *) i, NULL,
+     STACK_SIZE);
+    vtest(task);
+  }
+  tstart = lGetTimeStamp(exec);
+  for (int i = 0; i < NTASK; i++) {
+    lObtainSemaphore(exec, &finished);
+  }
+  t = lGetTimeStamp(exec) - tstart;
+  for (int i = 0; i < NTASK; i++) {
+    vtest(step[i] == NSTEP);
+  }
+  kprintf(exec, "yield0: %lu ticks for %d Yield() with %d tasks "
+   "on %d CPUs\n", t, NSTEP * NTASK, NTASK, ncpu);
+}
+
@@ -66,6 +66,7 @@ set gmake [exec [file join $script_dir gmake.sh]]
 set moddirs [list]
 lappend moddirs mod/exec
 lappend moddirs mod/expansion
+lappend moddirs mod/forkjoin
 lappend moddirs mod/devices
 
 set genheader [file join $script_dir genheader.tcl]